@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "arena.h"
+
+//> Internal Types
+struct _GSDLArenaChunk {
+	GSDLArenaChunk *prev;
+	gsize size;
+
+	// Keeps the data after the header suitably aligned for anything.
+	union {
+		gint64 i;
+		gdouble d;
+		gpointer p;
+	} data[];
+};
+
+//> Static Data
+#define CHUNK_SIZE 8192
+#define ALIGNMENT (sizeof(((GSDLArenaChunk*) NULL)->data[0]))
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1))
+
+//> Internal Functions
+static void _free_chunks_after(GSDLArena *self, GSDLArenaChunk *last) {
+	while (self->chunk != last) {
+		GSDLArenaChunk *prev = self->chunk->prev;
+
+		// Keep one standard-sized chunk around, so repeatedly crossing a chunk boundary doesn't
+		// thrash the allocator.
+		if (!self->spare && self->chunk->size == CHUNK_SIZE) {
+			self->spare = self->chunk;
+		} else {
+			g_free(self->chunk);
+		}
+
+		self->chunk = prev;
+	}
+}
+
+static void _new_chunk(GSDLArena *self, gsize min_size) {
+	GSDLArenaChunk *chunk;
+	gsize size = MAX(CHUNK_SIZE, min_size);
+
+	if (size == CHUNK_SIZE && self->spare) {
+		chunk = self->spare;
+		self->spare = NULL;
+	} else {
+		chunk = g_malloc(sizeof(GSDLArenaChunk) + size);
+		chunk->size = size;
+	}
+
+	chunk->prev = self->chunk;
+	self->chunk = chunk;
+	self->pos = (char*) chunk->data;
+	self->end = self->pos + size;
+}
+
+/*
+ * _gsdl_arena_alloc:
+ * @self: A valid %GSDLArena.
+ * @size: Number of bytes to allocate.
+ *
+ * Returns: A block of at least @size bytes, aligned for any type. It stays valid until the arena is
+ *          released past it or reset.
+ */
+gpointer _gsdl_arena_alloc(GSDLArena *self, gsize size) {
+	size = ALIGN(size);
+
+	if (G_UNLIKELY((gsize) (self->end - self->pos) < size)) _new_chunk(self, size);
+
+	gpointer result = self->pos;
+	self->pos += size;
+
+	return result;
+}
+
+gpointer _gsdl_arena_alloc0(GSDLArena *self, gsize size) {
+	return memset(_gsdl_arena_alloc(self, size), 0, size);
+}
+
+/*
+ * _gsdl_arena_strndup:
+ * @self: A valid %GSDLArena.
+ * @str: String to copy.
+ * @len: Number of bytes of @str to copy.
+ *
+ * Returns: A %NULL-terminated copy of the first @len bytes of @str.
+ */
+char* _gsdl_arena_strndup(GSDLArena *self, const char *str, gsize len) {
+	char *result = _gsdl_arena_alloc(self, len + 1);
+
+	memcpy(result, str, len);
+	result[len] = '\0';
+
+	return result;
+}
+
+/*
+ * _gsdl_arena_mark:
+ * @self: A valid %GSDLArena.
+ *
+ * Returns: A mark that can later be passed to _gsdl_arena_release().
+ */
+GSDLArenaMark _gsdl_arena_mark(GSDLArena *self) {
+	return (GSDLArenaMark) { self->chunk, self->pos };
+}
+
+/*
+ * _gsdl_arena_release:
+ * @self: A valid %GSDLArena.
+ * @mark: A mark returned by _gsdl_arena_mark() on this arena, that has not been released past.
+ *
+ * Frees everything allocated since @mark was taken.
+ */
+void _gsdl_arena_release(GSDLArena *self, GSDLArenaMark mark) {
+	_free_chunks_after(self, mark.chunk);
+
+	if (mark.chunk) {
+		self->pos = mark.pos;
+		self->end = (char*) mark.chunk->data + mark.chunk->size;
+	} else {
+		self->pos = self->end = NULL;
+	}
+}
+
+/*
+ * _gsdl_arena_reset:
+ * @self: A valid %GSDLArena.
+ *
+ * Frees everything allocated from the arena, but keeps its first chunk around for reuse.
+ */
+void _gsdl_arena_reset(GSDLArena *self) {
+	if (!self->chunk) return;
+
+	GSDLArenaChunk *first = self->chunk;
+	while (first->prev) first = first->prev;
+
+	_free_chunks_after(self, first);
+	self->pos = (char*) first->data;
+	self->end = self->pos + first->size;
+}
+
+/*
+ * _gsdl_arena_clear:
+ * @self: A valid %GSDLArena.
+ *
+ * Frees all memory held by the arena, leaving it empty.
+ */
+void _gsdl_arena_clear(GSDLArena *self) {
+	_free_chunks_after(self, NULL);
+	g_free(self->spare);
+
+	*self = (GSDLArena) { NULL, };
+}
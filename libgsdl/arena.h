@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// NOTE: This is an internal header, and is not installed.
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <glib.h>
+
+//> Types
+typedef struct _GSDLArenaChunk GSDLArenaChunk;
+
+/*
+ * GSDLArena:
+ *
+ * A simple bump-pointer allocator. Allocations are never freed individually; instead, everything
+ * allocated after a %GSDLArenaMark can be thrown away at once with _gsdl_arena_release(), or the
+ * whole arena with _gsdl_arena_reset().
+ *
+ * An all-zero %GSDLArena is a valid, empty arena.
+ */
+typedef struct {
+	GSDLArenaChunk *chunk;
+	char *pos;
+	char *end;
+
+	GSDLArenaChunk *spare;
+} GSDLArena;
+
+typedef struct {
+	GSDLArenaChunk *chunk;
+	char *pos;
+} GSDLArenaMark;
+
+//> Internal Functions
+extern gpointer _gsdl_arena_alloc(GSDLArena *self, gsize size);
+extern gpointer _gsdl_arena_alloc0(GSDLArena *self, gsize size);
+extern char* _gsdl_arena_strndup(GSDLArena *self, const char *str, gsize len);
+
+extern GSDLArenaMark _gsdl_arena_mark(GSDLArena *self);
+extern void _gsdl_arena_release(GSDLArena *self, GSDLArenaMark mark);
+extern void _gsdl_arena_reset(GSDLArena *self);
+extern void _gsdl_arena_clear(GSDLArena *self);
+
+#define _gsdl_arena_new0(arena, type, n) ((type*) _gsdl_arena_alloc0((arena), sizeof(type) * (n)))
+
+#endif
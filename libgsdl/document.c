@@ -0,0 +1,982 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:gsdl-document
+ * @short_description: In-memory tree of a parsed SDL document.
+ *
+ * A #GSDLDocument holds a whole parsed document, as a tree of tags addressed by index. Node 0 is the
+ * document itself, and its children are the top-level tags; as node 0 can never be a child or
+ * sibling of anything, it is also returned when there is no such node.
+ *
+ * Everything is stored in a single block of memory: the tags as parallel arrays, their values as
+ * compact #GSDLDocValues rather than #GValues, and their strings packed together. Tag and attribute
+ * names are interned, so each distinct name is stored once, and can be compared by id. Documents
+ * cannot be changed once built.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "document.h"
+#include "parser.h"
+#include "types.h"
+
+//> Macros
+#define CHECK_NODE(val) g_return_val_if_fail(node < self->n_nodes, val)
+
+//> Internal Types
+struct _GSDLDocument {
+	guint n_nodes;
+	guint n_attrs;
+	guint n_names;
+
+	// Indexed by node.
+	guint32 *node_names;
+	guint32 *node_values;
+	guint32 *node_n_values;
+	guint32 *node_attrs;
+	guint32 *node_n_attrs;
+	guint32 *node_first_child;
+	guint32 *node_next_sibling;
+
+	GSDLDocValue *values;
+	GSDLDocValue *attr_values;
+	guint32 *attr_names;
+
+	// Offsets of each name in strings, and an open-addressed hash table of name ids, where 0 marks an
+	// empty slot.
+	guint32 *name_offsets;
+	guint32 *name_table;
+	guint32 name_table_mask;
+
+	char *strings;
+
+	// Built the first time they are needed, as a %StructureIndex and an %AttrIndex.
+	volatile gsize structure_index;
+	volatile gsize attr_index;
+};
+
+/*
+ * StructureIndex:
+ * @parents: The parent of each node; 0 for top-level tags (and node 0 itself).
+ * @name_starts: Where the nodes with each name id start in @named_nodes, and where they end, as
+ *               the start of the next.
+ * @named_nodes: Every node other than 0, grouped by name, in document order within each group.
+ */
+typedef struct {
+	guint32 *parents;
+	guint32 *name_starts;
+	guint32 *named_nodes;
+} StructureIndex;
+
+/*
+ * AttrIndex:
+ * @table_mask: One less than the size of @table.
+ * @table: Open-addressed hash table of group numbers plus one, or 0 for an empty slot.
+ * @group_attrs: The first attribute in each group, which stands for the name and value of all of
+ *               them.
+ * @group_starts: Where the nodes with each group start in @group_nodes, and where they end, as
+ *                the start of the next.
+ * @group_nodes: Nodes with attributes of each name and value, in document order.
+ *
+ * Groups all string and integer attributes by name and value.
+ */
+typedef struct {
+	guint32 table_mask;
+	guint32 *table;
+	guint32 *group_attrs;
+	guint32 *group_starts;
+	guint32 *group_nodes;
+} AttrIndex;
+
+typedef struct {
+	guint32 name;
+	guint32 values;
+	guint32 n_values;
+	guint32 attrs;
+	guint32 n_attrs;
+	guint32 first_child;
+	guint32 next_sibling;
+} BuildNode;
+
+typedef struct {
+	guint32 node;
+	guint32 last_child;
+} BuildFrame;
+
+/*
+ * Builder:
+ *
+ * Collects a document as it is parsed, to be packed into a %GSDLDocument at the end. Strings are
+ * stored as offsets into strings until then, as it may move while growing.
+ */
+typedef struct {
+	GArray *nodes;
+	GArray *values;
+	GArray *attr_values;
+	GArray *attr_names;
+	GString *strings;
+
+	GHashTable *name_ids;
+	GArray *name_offsets;
+
+	GArray *stack;
+	GError *error;
+} Builder;
+
+extern void _gsdl_types_init();
+
+//> Building
+static guint32 _store(Builder *self, const char *data, gsize len) {
+	guint32 offset = self->strings->len;
+
+	g_string_append_len(self->strings, data, len);
+	g_string_append_c(self->strings, '\0');
+
+	return offset;
+}
+
+static guint32 _intern(Builder *self, const gchar *name) {
+	gpointer id;
+
+	if (g_hash_table_lookup_extended(self->name_ids, name, NULL, &id)) return GPOINTER_TO_UINT(id);
+
+	guint32 new_id = self->name_offsets->len, offset = _store(self, name, strlen(name));
+	g_array_append_val(self->name_offsets, offset);
+	g_hash_table_insert(self->name_ids, g_strdup(name), GUINT_TO_POINTER(new_id));
+
+	return new_id;
+}
+
+static void _convert_string(Builder *self, GSDLDocValue *result, GSDLDocValueType type, const char *data, gsize len) {
+	result->type = type;
+	result->len = len;
+	result->v_str = GSIZE_TO_POINTER(_store(self, data, len));
+}
+
+/*
+ * _convert:
+ * @self: A valid %Builder.
+ * @result: (out caller-allocates): Location to store the converted value.
+ * @value: A value produced by the parser.
+ *
+ * Converts a value to its compact form, copying any strings or data into the builder.
+ */
+static void _convert(Builder *self, GSDLDocValue *result, const GValue *value) {
+	GType type = G_VALUE_TYPE(value);
+
+	*result = (GSDLDocValue) { .type = GSDL_DOC_NULL };
+
+	if (type == G_TYPE_INT) {
+		result->type = GSDL_DOC_INT;
+		result->v_int = g_value_get_int(value);
+	} else if (type == G_TYPE_INT64) {
+		result->type = GSDL_DOC_INT64;
+		result->v_int = g_value_get_int64(value);
+	} else if (type == G_TYPE_FLOAT) {
+		result->type = GSDL_DOC_FLOAT;
+		result->v_double = g_value_get_float(value);
+	} else if (type == G_TYPE_DOUBLE) {
+		result->type = GSDL_DOC_DOUBLE;
+		result->v_double = g_value_get_double(value);
+	} else if (type == G_TYPE_BOOLEAN) {
+		result->type = GSDL_DOC_BOOLEAN;
+		result->v_int = g_value_get_boolean(value);
+	} else if (type == G_TYPE_STRING) {
+		const gchar *str = g_value_get_string(value);
+		_convert_string(self, result, GSDL_DOC_STRING, str, strlen(str));
+	} else if (type == GSDL_TYPE_DECIMAL) {
+		const gchar *str = gsdl_gvalue_get_decimal(value);
+		_convert_string(self, result, GSDL_DOC_DECIMAL, str, strlen(str));
+	} else if (type == GSDL_TYPE_BINARY) {
+		const GByteArray *bytes = gsdl_gvalue_get_binary(value);
+		_convert_string(self, result, GSDL_DOC_BINARY, (const char*) bytes->data, bytes->len);
+	} else if (type == GSDL_TYPE_UNICHAR) {
+		result->type = GSDL_DOC_CHAR;
+		result->v_int = gsdl_gvalue_get_unichar(value);
+	} else if (type == GSDL_TYPE_DATE) {
+		result->type = GSDL_DOC_DATE;
+		result->v_int = g_date_get_julian(gsdl_gvalue_get_date(value));
+	} else if (type == GSDL_TYPE_DATETIME) {
+		GDateTime *datetime = (GDateTime*) gsdl_gvalue_get_datetime(value);
+
+		result->type = GSDL_DOC_DATETIME;
+		result->v_int = g_date_time_to_unix(datetime) * G_USEC_PER_SEC + g_date_time_get_microsecond(datetime);
+		result->utc_offset = g_date_time_get_utc_offset(datetime) / G_USEC_PER_SEC;
+	} else if (type == GSDL_TYPE_TIMESPAN) {
+		result->type = GSDL_DOC_TIMESPAN;
+		result->v_int = gsdl_gvalue_get_timespan(value);
+	}
+}
+
+static void _start_tag(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GValue *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GValue *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	Builder *self = (Builder*) user_data;
+	guint32 index = self->nodes->len;
+	BuildNode node = {
+		.name = _intern(self, name),
+		.values = self->values->len,
+		.n_values = n_values,
+		.attrs = self->attr_values->len,
+		.n_attrs = n_attrs,
+	};
+
+	g_array_set_size(self->values, node.values + n_values);
+	for (guint i = 0; i < n_values; i++) {
+		_convert(self, &g_array_index(self->values, GSDLDocValue, node.values + i), &values[i]);
+	}
+
+	g_array_set_size(self->attr_values, node.attrs + n_attrs);
+	for (guint i = 0; i < n_attrs; i++) {
+		guint32 attr_name = _intern(self, attr_names[i]);
+		g_array_append_val(self->attr_names, attr_name);
+
+		_convert(self, &g_array_index(self->attr_values, GSDLDocValue, node.attrs + i), &attr_values[i]);
+	}
+
+	g_array_append_val(self->nodes, node);
+
+	// Link the new node in after its last sibling.
+	BuildFrame *parent = &g_array_index(self->stack, BuildFrame, self->stack->len - 1);
+	BuildNode *nodes = (BuildNode*) self->nodes->data;
+
+	if (parent->last_child) {
+		nodes[parent->last_child].next_sibling = index;
+	} else {
+		nodes[parent->node].first_child = index;
+	}
+	parent->last_child = index;
+
+	BuildFrame frame = { index, 0 };
+	g_array_append_val(self->stack, frame);
+}
+
+static void _end_tag(GSDLParserContext *context, const gchar *name, gpointer user_data, GError **err) {
+	Builder *self = (Builder*) user_data;
+
+	g_array_set_size(self->stack, self->stack->len - 1);
+}
+
+static void _error(GSDLParserContext *context, GError *err, gpointer user_data) {
+	Builder *self = (Builder*) user_data;
+
+	if (self->error) {
+		g_error_free(err);
+	} else {
+		self->error = err;
+	}
+}
+
+static GSDLParser BUILDER_PARSER = {
+	NULL,
+	_end_tag,
+	_error,
+	_start_tag,
+};
+
+static void _builder_init(Builder *self) {
+	self->nodes = g_array_new(FALSE, TRUE, sizeof(BuildNode));
+	self->values = g_array_new(FALSE, FALSE, sizeof(GSDLDocValue));
+	self->attr_values = g_array_new(FALSE, FALSE, sizeof(GSDLDocValue));
+	self->attr_names = g_array_new(FALSE, FALSE, sizeof(guint32));
+	self->strings = g_string_new("");
+	self->name_ids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	self->name_offsets = g_array_new(FALSE, FALSE, sizeof(guint32));
+	self->stack = g_array_new(FALSE, FALSE, sizeof(BuildFrame));
+	self->error = NULL;
+
+	// Node 0, for the document itself, has the name id 0 (the empty string).
+	BuildFrame frame = { 0, 0 };
+	g_array_set_size(self->nodes, 1);
+	g_array_append_val(self->stack, frame);
+	_intern(self, "");
+}
+
+static void _builder_clear(Builder *self) {
+	g_array_free(self->nodes, TRUE);
+	g_array_free(self->values, TRUE);
+	g_array_free(self->attr_values, TRUE);
+	g_array_free(self->attr_names, TRUE);
+	g_string_free(self->strings, TRUE);
+	g_hash_table_destroy(self->name_ids);
+	g_array_free(self->name_offsets, TRUE);
+	g_array_free(self->stack, TRUE);
+}
+
+static void _fix_strings(GSDLDocument *self, GSDLDocValue *values, guint n_values) {
+	for (guint i = 0; i < n_values; i++) {
+		GSDLDocValueType type = values[i].type;
+
+		if (type == GSDL_DOC_STRING || type == GSDL_DOC_DECIMAL || type == GSDL_DOC_BINARY) {
+			values[i].v_str = self->strings + GPOINTER_TO_SIZE(values[i].v_str);
+		}
+	}
+}
+
+/*
+ * _pack:
+ * @builder: A %Builder holding a complete document.
+ *
+ * Lays out everything collected by @builder in a single allocation.
+ *
+ * Returns: The new %GSDLDocument.
+ */
+static GSDLDocument* _pack(Builder *builder) {
+	guint n_nodes = builder->nodes->len, n_values = builder->values->len, n_attrs = builder->attr_values->len;
+	guint n_names = builder->name_offsets->len, table_size = 2;
+
+	while (table_size < n_names * 2) table_size *= 2;
+
+	// The values come first, straight after the header, so they are suitably aligned.
+	gsize values_at = sizeof(GSDLDocument);
+	gsize attr_values_at = values_at + n_values * sizeof(GSDLDocValue);
+	gsize nodes_at = attr_values_at + n_attrs * sizeof(GSDLDocValue);
+	gsize attr_names_at = nodes_at + 7 * n_nodes * sizeof(guint32);
+	gsize name_offsets_at = attr_names_at + n_attrs * sizeof(guint32);
+	gsize name_table_at = name_offsets_at + n_names * sizeof(guint32);
+	gsize strings_at = name_table_at + table_size * sizeof(guint32);
+
+	char *block = g_malloc(strings_at + builder->strings->len);
+	GSDLDocument *self = (GSDLDocument*) block;
+
+	self->n_nodes = n_nodes;
+	self->n_attrs = n_attrs;
+	self->n_names = n_names;
+	self->structure_index = 0;
+	self->attr_index = 0;
+	self->values = (GSDLDocValue*) (block + values_at);
+	self->attr_values = (GSDLDocValue*) (block + attr_values_at);
+	self->node_names = (guint32*) (block + nodes_at);
+	self->node_values = self->node_names + n_nodes;
+	self->node_n_values = self->node_values + n_nodes;
+	self->node_attrs = self->node_n_values + n_nodes;
+	self->node_n_attrs = self->node_attrs + n_nodes;
+	self->node_first_child = self->node_n_attrs + n_nodes;
+	self->node_next_sibling = self->node_first_child + n_nodes;
+	self->attr_names = (guint32*) (block + attr_names_at);
+	self->name_offsets = (guint32*) (block + name_offsets_at);
+	self->name_table = (guint32*) (block + name_table_at);
+	self->name_table_mask = table_size - 1;
+	self->strings = block + strings_at;
+
+	for (guint i = 0; i < n_nodes; i++) {
+		BuildNode *node = &g_array_index(builder->nodes, BuildNode, i);
+
+		self->node_names[i] = node->name;
+		self->node_values[i] = node->values;
+		self->node_n_values[i] = node->n_values;
+		self->node_attrs[i] = node->attrs;
+		self->node_n_attrs[i] = node->n_attrs;
+		self->node_first_child[i] = node->first_child;
+		self->node_next_sibling[i] = node->next_sibling;
+	}
+
+	memcpy(self->values, builder->values->data, n_values * sizeof(GSDLDocValue));
+	memcpy(self->attr_values, builder->attr_values->data, n_attrs * sizeof(GSDLDocValue));
+	memcpy(self->attr_names, builder->attr_names->data, n_attrs * sizeof(guint32));
+	memcpy(self->name_offsets, builder->name_offsets->data, n_names * sizeof(guint32));
+	memcpy(self->strings, builder->strings->str, builder->strings->len);
+
+	_fix_strings(self, self->values, n_values);
+	_fix_strings(self, self->attr_values, n_attrs);
+
+	memset(self->name_table, 0, table_size * sizeof(guint32));
+	for (guint32 id = 1; id < n_names; id++) {
+		guint32 i = g_str_hash(self->strings + self->name_offsets[id]) & self->name_table_mask;
+
+		while (self->name_table[i]) i = (i + 1) & self->name_table_mask;
+		self->name_table[i] = id;
+	}
+
+	return self;
+}
+
+static GSDLDocument* _builder_finish(Builder *self, bool success, GError **err) {
+	GSDLDocument *result = NULL;
+
+	if (success) {
+		result = _pack(self);
+	} else {
+		g_propagate_error(err, self->error);
+	}
+
+	_builder_clear(self);
+
+	return result;
+}
+
+//> Indices
+static bool _indexable(const GSDLDocValue *value) {
+	return value->type == GSDL_DOC_STRING || value->type == GSDL_DOC_INT || value->type == GSDL_DOC_INT64;
+}
+
+/*
+ * _gsdl_doc_value_equal:
+ * @a: A value.
+ * @b: Another value.
+ *
+ * Compares strings and integers (of either size). Values of any other type are never equal.
+ *
+ * Returns: Whether @a and @b are equal.
+ */
+bool _gsdl_doc_value_equal(const GSDLDocValue *a, const GSDLDocValue *b) {
+	if (a->type == GSDL_DOC_STRING) {
+		return b->type == GSDL_DOC_STRING && a->len == b->len && memcmp(a->v_str, b->v_str, a->len) == 0;
+	} else if (a->type == GSDL_DOC_INT || a->type == GSDL_DOC_INT64) {
+		return (b->type == GSDL_DOC_INT || b->type == GSDL_DOC_INT64) && a->v_int == b->v_int;
+	}
+
+	return false;
+}
+
+static guint32 _attr_hash(guint32 name, const GSDLDocValue *value) {
+	guint32 hash = name * 2654435761u;
+
+	if (value->type == GSDL_DOC_STRING) {
+		for (guint32 i = 0; i < value->len; i++) hash = hash * 31 + (guchar) value->v_str[i];
+	} else {
+		hash ^= (guint32) value->v_int * 2246822519u ^ (guint32) (value->v_int >> 32);
+	}
+
+	return hash ^ (hash >> 15);
+}
+
+/*
+ * _gsdl_document_get_structure:
+ * @self: A valid #GSDLDocument.
+ * @name_starts: (out) (allow-none): Location to store the start of each name's nodes in
+ *               @named_nodes, indexed by name id.
+ * @named_nodes: (out) (allow-none): Location to store the nodes grouped by name.
+ *
+ * Builds the document's parent links and name index on first use; safe to call from several
+ * threads at once.
+ *
+ * Returns: (transfer none): The parent of each node.
+ */
+const guint32* _gsdl_document_get_structure(const GSDLDocument *self, const guint32 **name_starts, const guint32 **named_nodes) {
+	GSDLDocument *doc = (GSDLDocument*) self;
+
+	if (g_once_init_enter(&doc->structure_index)) {
+		guint n_nodes = self->n_nodes, n_names = self->n_names;
+		StructureIndex *index = g_malloc(sizeof(StructureIndex) + (2 * n_nodes + n_names + 1) * sizeof(guint32));
+
+		index->parents = (guint32*) (index + 1);
+		index->name_starts = index->parents + n_nodes;
+		index->named_nodes = index->name_starts + n_names + 1;
+
+		index->parents[0] = 0;
+		for (guint32 node = 0; node < n_nodes; node++) {
+			for (guint32 child = self->node_first_child[node]; child; child = self->node_next_sibling[child]) {
+				index->parents[child] = node;
+			}
+		}
+
+		// Count the nodes with each name, then turn the counts into where each group ends and fill
+		// them in backwards, which leaves each count as where its group starts.
+		memset(index->name_starts, 0, (n_names + 1) * sizeof(guint32));
+		for (guint32 node = 1; node < n_nodes; node++) index->name_starts[self->node_names[node]]++;
+		for (guint32 i = 1; i <= n_names; i++) index->name_starts[i] += index->name_starts[i - 1];
+		for (guint32 node = n_nodes - 1; node >= 1; node--) {
+			index->named_nodes[--index->name_starts[self->node_names[node]]] = node;
+		}
+
+		g_once_init_leave(&doc->structure_index, (gsize) index);
+	}
+
+	StructureIndex *index = (StructureIndex*) self->structure_index;
+
+	if (name_starts) *name_starts = index->name_starts;
+	if (named_nodes) *named_nodes = index->named_nodes;
+
+	return index->parents;
+}
+
+static AttrIndex* _build_attr_index(const GSDLDocument *self) {
+	guint n_attrs = self->n_attrs, table_size = 2;
+
+	while (table_size < n_attrs * 2) table_size *= 2;
+
+	AttrIndex *index = g_malloc(sizeof(AttrIndex) + (table_size + 3 * n_attrs + 1) * sizeof(guint32));
+	index->table_mask = table_size - 1;
+	index->table = (guint32*) (index + 1);
+	index->group_attrs = index->table + table_size;
+	index->group_starts = index->group_attrs + n_attrs;
+	index->group_nodes = index->group_starts + n_attrs + 1;
+
+	memset(index->table, 0, table_size * sizeof(guint32));
+
+	// Find the group of each attribute and count the nodes in each, leaving out attributes repeated
+	// on the same node.
+	guint32 *attr_groups = g_new(guint32, n_attrs), *last_nodes = g_new(guint32, n_attrs);
+	guint32 n_groups = 0;
+
+	for (guint32 node = 1; node < self->n_nodes; node++) {
+		for (guint32 attr = self->node_attrs[node], end = attr + self->node_n_attrs[node]; attr < end; attr++) {
+			const GSDLDocValue *value = &self->attr_values[attr];
+			guint32 name = self->attr_names[attr], group = G_MAXUINT32;
+
+			attr_groups[attr] = G_MAXUINT32;
+			if (!_indexable(value)) continue;
+
+			for (guint32 i = _attr_hash(name, value) & index->table_mask; ; i = (i + 1) & index->table_mask) {
+				if (!index->table[i]) {
+					group = n_groups++;
+					index->table[i] = group + 1;
+					index->group_attrs[group] = attr;
+					index->group_starts[group] = 0;
+					last_nodes[group] = 0;
+					break;
+				}
+
+				guint32 other = index->group_attrs[index->table[i] - 1];
+				if (self->attr_names[other] == name && _gsdl_doc_value_equal(&self->attr_values[other], value)) {
+					group = index->table[i] - 1;
+					break;
+				}
+			}
+
+			if (last_nodes[group] == node) continue;
+
+			last_nodes[group] = node;
+			attr_groups[attr] = group;
+			index->group_starts[group]++;
+		}
+	}
+
+	index->group_starts[n_groups] = 0;
+	for (guint32 i = 1; i <= n_groups; i++) index->group_starts[i] += index->group_starts[i - 1];
+
+	// As in _gsdl_document_get_structure(), fill in each group backwards.
+	for (guint32 node = self->n_nodes - 1; node >= 1; node--) {
+		for (guint32 attr = self->node_attrs[node], end = attr + self->node_n_attrs[node]; attr < end; attr++) {
+			if (attr_groups[attr] != G_MAXUINT32) index->group_nodes[--index->group_starts[attr_groups[attr]]] = node;
+		}
+	}
+
+	g_free(attr_groups);
+	g_free(last_nodes);
+
+	return index;
+}
+
+/*
+ * _gsdl_document_find_attr_nodes:
+ * @self: A valid #GSDLDocument.
+ * @name_id: Name id of an attribute.
+ * @value: A string or integer value.
+ * @n_nodes: (out): Location to store the number of nodes found.
+ *
+ * Looks up the nodes with an attribute called @name_id that is equal to @value (as with
+ * _gsdl_doc_value_equal()). The index this uses is built on first use; this is safe to call from
+ * several threads at once.
+ *
+ * Returns: (transfer none): The nodes, in document order.
+ */
+const guint32* _gsdl_document_find_attr_nodes(const GSDLDocument *self, guint32 name_id, const GSDLDocValue *value, guint *n_nodes) {
+	GSDLDocument *doc = (GSDLDocument*) self;
+
+	if (g_once_init_enter(&doc->attr_index)) {
+		g_once_init_leave(&doc->attr_index, (gsize) _build_attr_index(self));
+	}
+
+	AttrIndex *index = (AttrIndex*) self->attr_index;
+	*n_nodes = 0;
+
+	if (!_indexable(value)) return NULL;
+
+	for (guint32 i = _attr_hash(name_id, value) & index->table_mask; index->table[i]; i = (i + 1) & index->table_mask) {
+		guint32 group = index->table[i] - 1, attr = index->group_attrs[group];
+
+		if (self->attr_names[attr] == name_id && _gsdl_doc_value_equal(&self->attr_values[attr], value)) {
+			*n_nodes = index->group_starts[group + 1] - index->group_starts[group];
+			return index->group_nodes + index->group_starts[group];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * _gsdl_document_get_attrs:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ * @names: (out): Location to store the name ids of @node's attributes.
+ * @values: (out): Location to store the values of @node's attributes.
+ *
+ * Returns: The number of attributes @node has.
+ */
+guint _gsdl_document_get_attrs(const GSDLDocument *self, guint node, const guint32 **names, const GSDLDocValue **values) {
+	*names = self->attr_names + self->node_attrs[node];
+	*values = self->attr_values + self->node_attrs[node];
+
+	return self->node_n_attrs[node];
+}
+
+//> Public Functions
+/**
+ * gsdl_document_new_from_file:
+ * @filename: Name of the file to parse.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Parses a whole file into a new document.
+ *
+ * Returns: A new #GSDLDocument, to be freed with gsdl_document_free(), or %NULL on failure.
+ */
+GSDLDocument* gsdl_document_new_from_file(const char *filename, GError **err) {
+	Builder builder;
+	_builder_init(&builder);
+
+	GSDLParserContext *context = gsdl_parser_context_new(&BUILDER_PARSER, &builder);
+	bool success = gsdl_parser_context_parse_file(context, filename);
+	gsdl_parser_context_free(context);
+
+	return _builder_finish(&builder, success, err);
+}
+
+/**
+ * gsdl_document_new_from_string:
+ * @str: A UTF-8 encoded string to parse.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Parses a whole string into a new document. The document does not refer to @str once built.
+ *
+ * Returns: A new #GSDLDocument, to be freed with gsdl_document_free(), or %NULL on failure.
+ */
+GSDLDocument* gsdl_document_new_from_string(const char *str, GError **err) {
+	Builder builder;
+	_builder_init(&builder);
+
+	GSDLParserContext *context = gsdl_parser_context_new(&BUILDER_PARSER, &builder);
+	bool success = gsdl_parser_context_parse_string(context, str);
+	gsdl_parser_context_free(context);
+
+	return _builder_finish(&builder, success, err);
+}
+
+/**
+ * gsdl_document_free:
+ * @self: A valid #GSDLDocument.
+ *
+ * Frees @self, along with all of its names and values.
+ */
+void gsdl_document_free(GSDLDocument *self) {
+	g_free((gpointer) self->structure_index);
+	g_free((gpointer) self->attr_index);
+	g_free(self);
+}
+
+/**
+ * gsdl_document_get_n_nodes:
+ * @self: A valid #GSDLDocument.
+ *
+ * Nodes are numbered in document order, from 0 (the document itself) up to one less than this.
+ *
+ * Returns: The number of nodes in the document, including node 0.
+ */
+guint gsdl_document_get_n_nodes(const GSDLDocument *self) {
+	return self->n_nodes;
+}
+
+/**
+ * gsdl_document_get_first_child:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: The first tag inside @node, or 0 if it has none.
+ */
+guint gsdl_document_get_first_child(const GSDLDocument *self, guint node) {
+	CHECK_NODE(0);
+
+	return self->node_first_child[node];
+}
+
+/**
+ * gsdl_document_get_next_sibling:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: The tag after @node in the same block, or 0 if it was the last.
+ */
+guint gsdl_document_get_next_sibling(const GSDLDocument *self, guint node) {
+	CHECK_NODE(0);
+
+	return self->node_next_sibling[node];
+}
+
+/**
+ * gsdl_document_get_name_id:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: The interned id of @node's name; the same for every tag or attribute with that name.
+ */
+guint gsdl_document_get_name_id(const GSDLDocument *self, guint node) {
+	CHECK_NODE(0);
+
+	return self->node_names[node];
+}
+
+/**
+ * gsdl_document_get_name:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: (transfer none): The name of @node; the empty string for node 0.
+ */
+const gchar* gsdl_document_get_name(const GSDLDocument *self, guint node) {
+	CHECK_NODE(NULL);
+
+	return self->strings + self->name_offsets[self->node_names[node]];
+}
+
+/**
+ * gsdl_document_name_from_id:
+ * @self: A valid #GSDLDocument.
+ * @name_id: A name id returned by gsdl_document_get_name_id() or gsdl_document_lookup_name().
+ *
+ * Returns: (transfer none): The name with the given id.
+ */
+const gchar* gsdl_document_name_from_id(const GSDLDocument *self, guint name_id) {
+	return self->strings + self->name_offsets[name_id];
+}
+
+/**
+ * gsdl_document_lookup_name:
+ * @self: A valid #GSDLDocument.
+ * @name: A tag or attribute name.
+ *
+ * Returns: The interned id of @name, or 0 if no tag or attribute in the document has that name.
+ */
+guint gsdl_document_lookup_name(const GSDLDocument *self, const gchar *name) {
+	guint32 mask = self->name_table_mask;
+
+	for (guint32 i = g_str_hash(name) & mask; self->name_table[i]; i = (i + 1) & mask) {
+		guint32 id = self->name_table[i];
+
+		if (strcmp(self->strings + self->name_offsets[id], name) == 0) return id;
+	}
+
+	return 0;
+}
+
+/**
+ * gsdl_document_get_n_values:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: The number of values @node has.
+ */
+guint gsdl_document_get_n_values(const GSDLDocument *self, guint node) {
+	CHECK_NODE(0);
+
+	return self->node_n_values[node];
+}
+
+/**
+ * gsdl_document_get_value:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ * @i: Index of one of its values.
+ *
+ * Returns: (transfer none): The value.
+ */
+const GSDLDocValue* gsdl_document_get_value(const GSDLDocument *self, guint node, guint i) {
+	CHECK_NODE(NULL);
+	g_return_val_if_fail(i < self->node_n_values[node], NULL);
+
+	return &self->values[self->node_values[node] + i];
+}
+
+/**
+ * gsdl_document_get_n_attrs:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ *
+ * Returns: The number of attributes @node has.
+ */
+guint gsdl_document_get_n_attrs(const GSDLDocument *self, guint node) {
+	CHECK_NODE(0);
+
+	return self->node_n_attrs[node];
+}
+
+/**
+ * gsdl_document_get_attr_name:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ * @i: Index of one of its attributes.
+ *
+ * Returns: (transfer none): The attribute's name.
+ */
+const gchar* gsdl_document_get_attr_name(const GSDLDocument *self, guint node, guint i) {
+	CHECK_NODE(NULL);
+	g_return_val_if_fail(i < self->node_n_attrs[node], NULL);
+
+	return self->strings + self->name_offsets[self->attr_names[self->node_attrs[node] + i]];
+}
+
+/**
+ * gsdl_document_get_attr_value:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ * @i: Index of one of its attributes.
+ *
+ * Returns: (transfer none): The attribute's value.
+ */
+const GSDLDocValue* gsdl_document_get_attr_value(const GSDLDocument *self, guint node, guint i) {
+	CHECK_NODE(NULL);
+	g_return_val_if_fail(i < self->node_n_attrs[node], NULL);
+
+	return &self->attr_values[self->node_attrs[node] + i];
+}
+
+/**
+ * gsdl_document_find_attr:
+ * @self: A valid #GSDLDocument.
+ * @node: Index of a node.
+ * @name: Name of the attribute to look for.
+ *
+ * Returns: (transfer none): The value of the first attribute of @node called @name, or %NULL if
+ *          there is none.
+ */
+const GSDLDocValue* gsdl_document_find_attr(const GSDLDocument *self, guint node, const gchar *name) {
+	CHECK_NODE(NULL);
+
+	guint32 id = gsdl_document_lookup_name(self, name);
+	if (!id) return NULL;
+
+	for (guint32 i = self->node_attrs[node], end = i + self->node_n_attrs[node]; i < end; i++) {
+		if (self->attr_names[i] == id) return &self->attr_values[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * gsdl_doc_value_to_gvalue:
+ * @value: A value from a #GSDLDocument.
+ * @out: (out caller-allocates): A zero-filled #GValue to store the value in. It must be unset by
+ *       the caller.
+ *
+ * Converts a document value to the same #GValue that the parser would have produced for it.
+ */
+void gsdl_doc_value_to_gvalue(const GSDLDocValue *value, GValue *out) {
+	_gsdl_types_init();
+
+	switch (value->type) {
+		case GSDL_DOC_NULL:
+			g_value_init(out, G_TYPE_POINTER);
+			break;
+
+		case GSDL_DOC_BOOLEAN:
+			g_value_init(out, G_TYPE_BOOLEAN);
+			g_value_set_boolean(out, value->v_int);
+			break;
+
+		case GSDL_DOC_INT:
+			g_value_init(out, G_TYPE_INT);
+			g_value_set_int(out, value->v_int);
+			break;
+
+		case GSDL_DOC_INT64:
+			g_value_init(out, G_TYPE_INT64);
+			g_value_set_int64(out, value->v_int);
+			break;
+
+		case GSDL_DOC_FLOAT:
+			g_value_init(out, G_TYPE_FLOAT);
+			g_value_set_float(out, value->v_double);
+			break;
+
+		case GSDL_DOC_DOUBLE:
+			g_value_init(out, G_TYPE_DOUBLE);
+			g_value_set_double(out, value->v_double);
+			break;
+
+		case GSDL_DOC_DECIMAL:
+			g_value_init(out, GSDL_TYPE_DECIMAL);
+			gsdl_gvalue_set_decimal(out, value->v_str);
+			break;
+
+		case GSDL_DOC_STRING:
+			g_value_init(out, G_TYPE_STRING);
+			g_value_set_string(out, value->v_str);
+			break;
+
+		case GSDL_DOC_CHAR:
+			g_value_init(out, GSDL_TYPE_UNICHAR);
+			gsdl_gvalue_set_unichar(out, value->v_int);
+			break;
+
+		case GSDL_DOC_BINARY: {
+			GByteArray *bytes = g_byte_array_sized_new(value->len);
+			g_byte_array_append(bytes, (const guint8*) value->v_str, value->len);
+
+			g_value_init(out, GSDL_TYPE_BINARY);
+			gsdl_gvalue_take_binary(out, bytes);
+			break;
+		}
+
+		case GSDL_DOC_DATE: {
+			GDate *date = g_date_new_julian(value->v_int);
+
+			// Makes GLib fill in the day, month and year, which are read directly when formatting.
+			g_date_get_year(date);
+
+			g_value_init(out, GSDL_TYPE_DATE);
+			gsdl_gvalue_take_date(out, date);
+			break;
+		}
+
+		case GSDL_DOC_DATETIME: {
+			gint32 offset = abs(value->utc_offset);
+			char identifier[16];
+
+			g_snprintf(identifier, sizeof(identifier), "%c%02d:%02d:%02d", value->utc_offset < 0 ? '-' : '+', offset / 3600, offset / 60 % 60, offset % 60);
+
+			GTimeZone *timezone = g_time_zone_new(identifier);
+			GDateTime *epoch = g_date_time_new_from_unix_utc(0), *utc = g_date_time_add(epoch, value->v_int);
+
+			g_value_init(out, GSDL_TYPE_DATETIME);
+			gsdl_gvalue_take_datetime(out, g_date_time_to_timezone(utc, timezone));
+
+			g_date_time_unref(epoch);
+			g_date_time_unref(utc);
+			g_time_zone_unref(timezone);
+			break;
+		}
+
+		case GSDL_DOC_TIMESPAN:
+			g_value_init(out, GSDL_TYPE_TIMESPAN);
+			gsdl_gvalue_set_timespan(out, value->v_int);
+			break;
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __DOCUMENT_H__
+#define __DOCUMENT_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdbool.h>
+
+/**
+ * GSDLDocument:
+ *
+ * All fields in GSDLDocument are private.
+ */
+typedef struct _GSDLDocument GSDLDocument;
+
+/**
+ * GSDLDocValueType:
+ * @GSDL_DOC_NULL: null.
+ * @GSDL_DOC_BOOLEAN: A boolean, in %v_int.
+ * @GSDL_DOC_INT: A 32-bit integer, in %v_int.
+ * @GSDL_DOC_INT64: A 64-bit integer, in %v_int.
+ * @GSDL_DOC_FLOAT: A single-precision float, in %v_double.
+ * @GSDL_DOC_DOUBLE: A double, in %v_double.
+ * @GSDL_DOC_DECIMAL: A decimal, as a string in %v_str.
+ * @GSDL_DOC_STRING: A string, in %v_str.
+ * @GSDL_DOC_CHAR: A #gunichar, in %v_int.
+ * @GSDL_DOC_BINARY: Binary data, in %v_str.
+ * @GSDL_DOC_DATE: A date, as a Julian day (see g_date_get_julian()) in %v_int.
+ * @GSDL_DOC_DATETIME: A date and time, as microseconds since the Unix epoch in %v_int, and the UTC
+ *                     offset it was given in, in seconds, in %utc_offset.
+ * @GSDL_DOC_TIMESPAN: A #GTimeSpan, in %v_int.
+ *
+ * The kinds of values stored in a #GSDLDocument; one for each of the types the parser produces.
+ */
+typedef enum {
+	GSDL_DOC_NULL,
+	GSDL_DOC_BOOLEAN,
+	GSDL_DOC_INT,
+	GSDL_DOC_INT64,
+	GSDL_DOC_FLOAT,
+	GSDL_DOC_DOUBLE,
+	GSDL_DOC_DECIMAL,
+	GSDL_DOC_STRING,
+	GSDL_DOC_CHAR,
+	GSDL_DOC_BINARY,
+	GSDL_DOC_DATE,
+	GSDL_DOC_DATETIME,
+	GSDL_DOC_TIMESPAN,
+} GSDLDocValueType;
+
+/**
+ * GSDLDocValue:
+ * @type: Which kind of value this is, and which of the fields below holds it.
+ * @len: Length in bytes of %v_str, not counting the nul byte after it.
+ * @utc_offset: UTC offset of a %GSDL_DOC_DATETIME, in seconds.
+ * @v_int: Integer contents.
+ * @v_double: Floating-point contents.
+ * @v_str: String or binary contents, owned by the document.
+ *
+ * A value or attribute in a #GSDLDocument, stored without any separate allocations.
+ */
+typedef struct {
+	GSDLDocValueType type;
+
+	union {
+		guint32 len;
+		gint32 utc_offset;
+	};
+
+	union {
+		gint64 v_int;
+		gdouble v_double;
+		const gchar *v_str;
+	};
+} GSDLDocValue;
+
+extern GSDLDocument* gsdl_document_new_from_file(const char *filename, GError **err);
+extern GSDLDocument* gsdl_document_new_from_string(const char *str, GError **err);
+extern void gsdl_document_free(GSDLDocument *self);
+
+extern guint gsdl_document_get_n_nodes(const GSDLDocument *self);
+extern guint gsdl_document_get_first_child(const GSDLDocument *self, guint node);
+extern guint gsdl_document_get_next_sibling(const GSDLDocument *self, guint node);
+
+extern guint gsdl_document_get_name_id(const GSDLDocument *self, guint node);
+extern const gchar* gsdl_document_get_name(const GSDLDocument *self, guint node);
+extern const gchar* gsdl_document_name_from_id(const GSDLDocument *self, guint name_id);
+extern guint gsdl_document_lookup_name(const GSDLDocument *self, const gchar *name);
+
+extern guint gsdl_document_get_n_values(const GSDLDocument *self, guint node);
+extern const GSDLDocValue* gsdl_document_get_value(const GSDLDocument *self, guint node, guint i);
+
+extern guint gsdl_document_get_n_attrs(const GSDLDocument *self, guint node);
+extern const gchar* gsdl_document_get_attr_name(const GSDLDocument *self, guint node, guint i);
+extern const GSDLDocValue* gsdl_document_get_attr_value(const GSDLDocument *self, guint node, guint i);
+extern const GSDLDocValue* gsdl_document_find_attr(const GSDLDocument *self, guint node, const gchar *name);
+
+extern void gsdl_doc_value_to_gvalue(const GSDLDocValue *value, GValue *out);
+
+#endif
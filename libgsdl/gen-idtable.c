@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Generates idtable.h, the lookup tables the tokenizer uses to find the end of identifiers, from
+// GLib's Unicode data. Run at build time; the result is written to standard output.
+//
+// ID_ASCII is a bitmap of the ASCII characters that may continue an identifier. The rest of the
+// Basic Multilingual Plane is covered by a two-level table: ID_BLOCK_INDEX maps the top byte of a
+// character to one of the distinct 256-character bitmaps in ID_BLOCKS.
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "idchar.h"
+
+#define BLOCK_WORDS 8
+
+int main() {
+	guint32 blocks[256][BLOCK_WORDS];
+	guint8 index[256];
+	int num_blocks = 0;
+
+	for (int hi = 0; hi < 256; hi++) {
+		guint32 block[BLOCK_WORDS] = {0};
+
+		for (int lo = 0; lo < 256; lo++) {
+			if (_gsdl_unichar_is_identifier(hi << 8 | lo)) block[lo >> 5] |= 1u << (lo & 31);
+		}
+
+		int i;
+		for (i = 0; i < num_blocks; i++) {
+			if (memcmp(blocks[i], block, sizeof(block)) == 0) break;
+		}
+
+		if (i == num_blocks) memcpy(blocks[num_blocks++], block, sizeof(block));
+		index[hi] = i;
+	}
+
+	printf("// Generated by gen-idtable; do not edit.\n\n");
+
+	printf("static const guint32 ID_ASCII[4] = {");
+	for (int i = 0; i < 4; i++) printf("%s0x%08x", i ? ", " : "", blocks[index[0]][i]);
+	printf("};\n\n");
+
+	printf("static const guint8 ID_BLOCK_INDEX[256] = {");
+	for (int i = 0; i < 256; i++) printf("%s%d", i % 16 ? ", " : (i ? ",\n\t" : "\n\t"), index[i]);
+	printf("\n};\n\n");
+
+	printf("static const guint32 ID_BLOCKS[%d][%d] = {\n", num_blocks, BLOCK_WORDS);
+	for (int i = 0; i < num_blocks; i++) {
+		printf("\t{");
+		for (int j = 0; j < BLOCK_WORDS; j++) printf("%s0x%08x", j ? ", " : "", blocks[i][j]);
+		printf("},\n");
+	}
+	printf("};\n");
+
+	return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// NOTE: This is an internal header, and is not installed.
+
+#ifndef __IDCHAR_H__
+#define __IDCHAR_H__
+
+#include <glib.h>
+#include <stdbool.h>
+
+/*
+ * _gsdl_unichar_is_identifier:
+ * @c: Any Unicode character.
+ *
+ * Checks whether @c may continue an SDL identifier, using GLib's Unicode tables. This is slow; it is
+ * used by gen-idtable to build the tokenizer's lookup tables, and by the tokenizer itself for
+ * characters outside of the Basic Multilingual Plane.
+ *
+ * Returns: Whether @c may appear after the first character of an identifier.
+ */
+static inline bool _gsdl_unichar_is_identifier(gunichar c) {
+	GUnicodeType type;
+
+	return c == '-' || c == '.' || g_unichar_isalpha(c) || g_unichar_isdigit(c) || (type = g_unichar_type(c)) == G_UNICODE_CURRENCY_SYMBOL || type == G_UNICODE_CONNECT_PUNCTUATION || type == G_UNICODE_LETTER_NUMBER || type == G_UNICODE_SPACING_MARK || type == G_UNICODE_NON_SPACING_MARK;
+}
+
+#endif
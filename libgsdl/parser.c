@@ -24,33 +24,175 @@
  * attribute contents come through as pre-parsed GValues.
  */
 
-#include <errno.h>
 #include <glib.h>
 #include <glib-object.h>
+#include <locale.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "parser.h"
+#include "path.h"
 #include "syntax.h"
 #include "tokenizer.h"
 #include "types.h"
 
+// Number of tokens fetched from the tokenizer at once.
+#define TOKEN_BATCH_SIZE 64
+
+typedef enum {
+	// Expecting a tag, or the end of the current block.
+	STATE_STATEMENT,
+	// start_tag has been called; expecting the tag's block or the end of the tag.
+	STATE_AFTER_HEADER,
+	// The tag has ended; expecting a separator.
+	STATE_AFTER_TAG,
+	// Moving past the values of a hidden tag, or the block of a tag whose children were skipped,
+	// without parsing them.
+	STATE_SKIPPING,
+	STATE_DONE,
+} ParserState;
+
+/*
+ * ScratchVector:
+ *
+ * A %NULL-terminated, growable array of pointers, used to pass a tag's values and attributes to
+ * start_tag. The context keeps one of each, which are emptied rather than freed between tags.
+ */
+typedef struct {
+	gpointer *items;
+	gsize len;
+	gsize alloc;
+} ScratchVector;
+
+/*
+ * ValueBlock:
+ *
+ * A growable, contiguous array of %GValues. Growing it may move the values, so pointers to them are
+ * only taken once all of a tag's values have been parsed.
+ */
+typedef struct {
+	GValue *items;
+	guint len;
+	guint alloc;
+} ValueBlock;
+
+typedef struct {
+	GSDLParser *parser;
+	gpointer user_data;
+} CallbackFrame;
+
+/*
+ * ProjectionNode:
+ *
+ * A node in the trie that projections are compiled into. Each tag that is parsed reaches the
+ * children of the nodes its parent reached that match its name; with wildcards, that can be several
+ * nodes at once.
+ */
+typedef struct _ProjectionNode ProjectionNode;
+struct _ProjectionNode {
+	// Name of the tag to match, or NULL for any tag.
+	char *name;
+	GPtrArray *children;
+
+	// Whether a projection ends here, and if so, the attributes it picks out (NULL for all of them).
+	bool match;
+	GPtrArray *attrs;
+};
+
+typedef struct {
+	char *name;
+
+	// Taken before the tag's name was allocated.
+	GSDLArenaMark mark;
+
+	// Whether the tag is only being parsed for the sake of its children, without calling start_tag
+	// or end_tag.
+	bool hidden;
+
+	// Where the projection nodes reached by this tag start in projection_states.
+	guint states_start;
+} OpenTag;
+
 struct _GSDLParserContext {
 	GSDLTokenizer *tokenizer;
-	GSDLToken *peek_token;
+
+	GSDLToken tokens[TOKEN_BATCH_SIZE];
+	// Usually tokens, but points at a lazy value's tokens while it is being decoded.
+	GSDLToken *token_buf;
+	gsize token_pos;
+	gsize token_count;
+	GError *token_error;
+
+	// Backs everything allocated while parsing; reset at the end of each parse.
+	GSDLArena arena;
+
+	ParserState state;
+	GArray *open_tags;
+	guint max_depth;
+
+	// Set by gsdl_parser_context_skip_children() until the tag's block (if any) is reached.
+	bool skip_children;
+	guint skip_depth;
+
+	// Root of the compiled projections, if any, followed by the nodes reached by each open tag.
+	ProjectionNode *projection;
+	GPtrArray *projection_states;
+
+	// Only used until start_tag returns, so they can be shared by tags at every depth.
+	ValueBlock values;
+	ValueBlock attr_values;
+	ScratchVector attr_names;
+	GString *attr_name_buf;
+
+	// Pointers to the above values, for start_tag.
+	ScratchVector value_ptrs;
+	ScratchVector attr_value_ptrs;
+
+	// Lazy mode state. The tokens of each value are kept, followed by a sentinel, so they can be
+	// parsed again by gsdl_parser_context_decode(). Any token values that would have been freed
+	// along with their batch are taken over, and freed after start_tag_lazy returns.
+	GArray *value_refs;
+	GArray *attr_refs;
+	GArray *lazy_tokens;
+	ScratchVector lazy_owned;
+	GError **decode_err;
+
+	// Push-mode state. In push mode, tokens are fetched one at a time, so the position of the
+	// buffered token (if any) is known.
+	bool feeding;
+	bool failed;
+	bool need_more;
+	gsize token_start;
+
+	// Set by a callback to make _run() return after the current step. The values of the tag that
+	// was just started are kept until the parse is resumed.
+	bool paused;
 
 	GSDLParser *parser;
 	gpointer user_data;
 
-	GSList *parser_stack;
-	GSList *data_stack;
+	// Callbacks saved by gsdl_parser_context_push().
+	GArray *callback_frames;
 };
 
-#define EXPECT(...) if (!_expect(self, token, __VA_ARGS__, 0)) return false;
+#define EXPECT(...) if (!_expect(self, &token, __VA_ARGS__, 0)) return false;
 #define MAYBE_CALLBACK(callback, ...) if (callback) callback(__VA_ARGS__)
 #define REQUIRE(expr) if (!expr) return false;
 
+extern GSDLTokenizer* _gsdl_tokenizer_new();
+extern bool _gsdl_tokenizer_open_file(GSDLTokenizer *self, const char *filename, GError **err);
+extern bool _gsdl_tokenizer_open_string(GSDLTokenizer *self, const char *str, GError **err);
+extern void _gsdl_tokenizer_open_push(GSDLTokenizer *self);
+extern void _gsdl_tokenizer_close(GSDLTokenizer *self);
+extern gsize _gsdl_tokenizer_get_position(GSDLTokenizer *self);
+extern void _gsdl_tokenizer_set_position(GSDLTokenizer *self, gsize offset);
+extern char* _gsdl_tokenizer_steal_value(GSDLTokenizer *self, GSDLToken *token);
+extern bool _gsdl_tokenizer_skip(GSDLTokenizer *self, guint *depth, GError **err);
+extern void _gsdl_types_init();
+
 /**
  * gsdl_parser_context_new:
  * @parser: A set of parsing callbacks.
@@ -65,10 +207,80 @@ GSDLParserContext* gsdl_parser_context_new(GSDLParser *parser, gpointer user_dat
 
 	self->parser = parser;
 	self->user_data = user_data;
+	self->tokenizer = _gsdl_tokenizer_new();
+	self->open_tags = g_array_new(FALSE, FALSE, sizeof(OpenTag));
+	self->callback_frames = g_array_new(FALSE, FALSE, sizeof(CallbackFrame));
+	self->token_buf = self->tokens;
+	self->value_refs = g_array_new(FALSE, FALSE, sizeof(GSDLValueRef));
+	self->attr_refs = g_array_new(FALSE, FALSE, sizeof(GSDLValueRef));
+	self->lazy_tokens = g_array_new(FALSE, FALSE, sizeof(GSDLToken));
+	self->attr_name_buf = g_string_new("");
+	self->projection_states = g_ptr_array_new();
 
 	return self;
 }
 
+static void _projection_free(ProjectionNode *node);
+
+static bool _finish(GSDLParserContext *self, bool success);
+
+/**
+ * gsdl_parser_context_reset:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Prepares @self to parse another document. Any parse started with gsdl_parser_context_feed() is
+ * abandoned, without calling end_tag for the tags that were still open, and any callbacks pushed
+ * with gsdl_parser_context_push() are popped; their user data is not freed.
+ *
+ * Configuration is not reset: projections added with gsdl_parser_context_add_projection() and the
+ * limit set with gsdl_parser_context_set_max_depth() still apply to the next document. Use
+ * gsdl_parser_context_clear_projections() and gsdl_parser_context_set_max_depth() with 0 to
+ * remove them.
+ *
+ * The context's internal buffers are kept, so parsing many small documents with a single context
+ * avoids allocating them over and over.
+ */
+void gsdl_parser_context_reset(GSDLParserContext *self) {
+	while (self->callback_frames->len) gsdl_parser_context_pop(self);
+
+	self->failed = false;
+	_finish(self, false);
+}
+
+/**
+ * gsdl_parser_context_free:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Frees @self and all resources associated with it. The user data of any callbacks still pushed
+ * onto it is not freed.
+ */
+void gsdl_parser_context_free(GSDLParserContext *self) {
+	gsdl_tokenizer_free(self->tokenizer);
+	g_clear_error(&self->token_error);
+
+	_gsdl_arena_clear(&self->arena);
+	g_array_unref(self->open_tags);
+
+	g_free(self->values.items);
+	g_free(self->attr_values.items);
+	g_free(self->attr_names.items);
+	g_string_free(self->attr_name_buf, TRUE);
+	g_free(self->value_ptrs.items);
+	g_free(self->attr_value_ptrs.items);
+
+	g_array_unref(self->value_refs);
+	g_array_unref(self->attr_refs);
+	g_array_unref(self->lazy_tokens);
+	g_free(self->lazy_owned.items);
+
+	g_array_unref(self->callback_frames);
+
+	if (self->projection) _projection_free(self->projection);
+	g_ptr_array_free(self->projection_states, TRUE);
+
+	g_slice_free(GSDLParserContext, self);
+}
+
 /**
  * gsdl_parser_context_push:
  * @self: A valid #GSDLParserContext.
@@ -78,8 +290,8 @@ GSDLParserContext* gsdl_parser_context_new(GSDLParser *parser, gpointer user_dat
  * Changes the active set of parsing callbacks. The old set can be restored with gsdl_parser_context_pop().
  */
 void gsdl_parser_context_push(GSDLParserContext *self, GSDLParser *parser, gpointer user_data) {
-	self->parser_stack = g_slist_prepend(self->parser_stack, self->parser);
-	self->data_stack = g_slist_prepend(self->data_stack, self->user_data);
+	CallbackFrame frame = { self->parser, self->user_data };
+	g_array_append_val(self->callback_frames, frame);
 
 	self->parser = parser;
 	self->user_data = user_data;
@@ -94,74 +306,145 @@ void gsdl_parser_context_push(GSDLParserContext *self, GSDLParser *parser, gpoin
  * Returns: the %user_data from the removed set of callbacks.
  */
 gpointer gsdl_parser_context_pop(GSDLParserContext *self) {
-	g_assert(self->parser_stack != NULL && self->data_stack != NULL);
+	g_assert(self->callback_frames->len != 0);
 
 	gpointer prev_data = self->user_data;
+	CallbackFrame frame = g_array_index(self->callback_frames, CallbackFrame, self->callback_frames->len - 1);
 
-	self->parser = self->parser_stack->data;
-	self->user_data = self->data_stack->data;
-
-	self->parser_stack = self->parser_stack->next;
-	self->data_stack = self->data_stack->next;
+	self->parser = frame.parser;
+	self->user_data = frame.user_data;
+	g_array_set_size(self->callback_frames, self->callback_frames->len - 1);
 
 	return prev_data;
 }
 
-static bool _read(GSDLParserContext *self, GSDLToken **token) {
-	if (self->peek_token) {
-		GSDLToken *result = self->peek_token;
-		self->peek_token = NULL;
-		*token = result;
+/**
+ * gsdl_parser_context_set_max_depth:
+ * @self: A valid #GSDLParserContext.
+ * @max_depth: The maximum number of tags that may be open at once, or 0 for no limit.
+ *
+ * Limits how deeply tags may be nested, for parsing untrusted input. Going past the limit is a
+ * %GSDL_SYNTAX_ERROR_TOO_DEEP error. There is no limit by default; the parser does not recurse, so
+ * nesting only costs a few bytes of heap per open tag.
+ */
+void gsdl_parser_context_set_max_depth(GSDLParserContext *self, guint max_depth) {
+	self->max_depth = max_depth;
+}
 
-		return true;
-	} else {
-		GError *error = NULL;
+/**
+ * gsdl_parser_context_skip_children:
+ * @self: A valid #GSDLParserContext.
+ *
+ * May be called from %start_tag (or either of its variants) to skip the children of the tag being
+ * started. The tag's block is only scanned for matching braces, so none of the tags inside it are
+ * tokenized or parsed, and no callbacks are called for them; end_tag is still called for the tag
+ * itself. Errors inside the block, other than a missing '}', are not reported.
+ *
+ * Has no effect if the tag has no block.
+ */
+void gsdl_parser_context_skip_children(GSDLParserContext *self) {
+	self->skip_children = true;
+}
 
-		if (!gsdl_tokenizer_next(self->tokenizer, token, &error)) {
-			MAYBE_CALLBACK(self->parser->error, self, error, self->user_data);
-			return false;
-		} else {
-			return true;
-		}
-	}
+/*
+ * _gsdl_parser_context_get_depth:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Returns: The number of tags currently open, including any hidden by projections. During
+ *          start_tag, this does not include the tag being started.
+ */
+guint _gsdl_parser_context_get_depth(const GSDLParserContext *self) {
+	return self->open_tags->len;
 }
 
-static bool _peek(GSDLParserContext *self, GSDLToken **token) {
-	if (self->peek_token) {
-		*token = self->peek_token;
+/*
+ * _fill:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Makes sure there is at least one token waiting in the token buffer, fetching another batch from
+ * the tokenizer if needed. A tokenizer error is only reported once the tokens before it have all
+ * been used up.
+ *
+ * Returns: Whether a token is available.
+ */
+static bool _fill(GSDLParserContext *self) {
+	if (G_LIKELY(self->token_pos < self->token_count)) return true;
 
-		return true;
-	} else {
-		GError *error = NULL;
+	// Decoding a lazy value never reads past the sentinel after its tokens.
+	if (self->decode_err) g_return_val_if_reached(false);
 
-		if (!gsdl_tokenizer_next(self->tokenizer, &(self->peek_token), &error)) {
-			MAYBE_CALLBACK(self->parser->error, self, error, self->user_data);
-			return false;
-		} else {
-			*token = self->peek_token;
-			return true;
-		}
+	if (self->token_error) {
+		GError *error = self->token_error;
+		self->token_error = NULL;
+
+		MAYBE_CALLBACK(self->parser->error, self, error, self->user_data);
+		return false;
+	}
+
+	self->token_pos = 0;
+	if (self->feeding) self->token_start = _gsdl_tokenizer_get_position(self->tokenizer);
+
+	if (!gsdl_tokenizer_next_batch(self->tokenizer, self->tokens, self->feeding ? 1 : TOKEN_BATCH_SIZE, &self->token_count, &self->token_error) && !self->token_error) {
+		// Either the push-mode tokenizer needs more input, or we're reading past the end of the input.
+		self->need_more = self->feeding;
+		return false;
 	}
+
+	return _fill(self);
+}
+
+/*
+ * _read:
+ * @self: A valid #GSDLParserContext.
+ * @token: (out caller-allocates): Location to copy the next token into.
+ *
+ * Tokens are copied out of the token buffer, as it will be overwritten by the next batch. Their
+ * values stay valid until the next batch is fetched (for unescaped strings) or until the end of the
+ * parse (for everything else, which points into the input).
+ *
+ * Returns: Whether a token could be read.
+ */
+static bool _read(GSDLParserContext *self, GSDLToken *token) {
+	REQUIRE(_fill(self));
+
+	*token = self->token_buf[self->token_pos++];
+	return true;
+}
+
+static bool _peek(GSDLParserContext *self, GSDLToken *token) {
+	REQUIRE(_fill(self));
+
+	*token = self->token_buf[self->token_pos];
+	return true;
 }
 
 static void _consume(GSDLParserContext *self) {
-	g_assert(self->peek_token != NULL);
+	g_assert(self->token_pos < self->token_count);
 
-	self->peek_token = NULL;
+	self->token_pos++;
 }
 
 static void _error(GSDLParserContext *self, GSDLToken *token, GSDLSyntaxError err_type, char *msg) {
 	GError *err = NULL;
+	guint line, col;
+
+	gsdl_tokenizer_get_location(self->tokenizer, token->offset, &line, &col);
 	g_set_error(&err,
 		GSDL_SYNTAX_ERROR,
 		err_type,
 		"%s in %s, line %d, column %d",
 		msg,
 		gsdl_tokenizer_get_filename(self->tokenizer),
-		token->line,
-		token->col
+		line,
+		col
 	);
-	MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+
+	if (self->decode_err) {
+		// Errors while decoding a lazy value go back to whoever asked for it.
+		g_propagate_error(self->decode_err, err);
+	} else {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+	}
 }
 
 static bool _expect(GSDLParserContext *self, GSDLToken *token, ...) {
@@ -204,6 +487,119 @@ static bool _expect(GSDLParserContext *self, GSDLToken *token, ...) {
 	}
 }
 
+//> Token Helpers
+static bool _token_equal(GSDLToken *token, const char *str) {
+	return strncmp(token->val, str, token->len) == 0 && str[token->len] == '\0';
+}
+
+static int _token_to_int(GSDLToken *token) {
+	return MIN(token->num, G_MAXINT);
+}
+
+//> Number Conversion
+// Every power of ten that can be exactly represented as a double, and as a float.
+static const double POWERS_OF_TEN[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static const float FLOAT_POWERS_OF_TEN[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+/*
+ * _number_string:
+ * @sign: 1 or -1.
+ * @int_part: The number before the decimal point.
+ * @frac_part: The number after the decimal point.
+ * @point: The decimal point to use.
+ *
+ * Returns: A newly-allocated string containing the whole number.
+ */
+static char* _number_string(int sign, GSDLToken *int_part, GSDLToken *frac_part, const char *point) {
+	gsize point_len = strlen(point);
+	char *result = g_malloc(int_part->len + point_len + frac_part->len + 2), *p = result;
+
+	if (sign < 0) *p++ = '-';
+	memcpy(p, int_part->val, int_part->len);
+	p += int_part->len;
+	memcpy(p, point, point_len);
+	p += point_len;
+	memcpy(p, frac_part->val, frac_part->len);
+	p[frac_part->len] = '\0';
+
+	return result;
+}
+
+/*
+ * _mantissa:
+ * @int_part: The number before the decimal point.
+ * @frac_part: The number after the decimal point.
+ * @result: (out): Location to store the number, with the decimal point removed.
+ *
+ * Returns: Whether the number had few enough digits to fit in @result.
+ */
+static bool _mantissa(GSDLToken *int_part, GSDLToken *frac_part, guint64 *result) {
+	if (int_part->len + frac_part->len > 19) return false;
+
+	*result = int_part->num * (guint64) POWERS_OF_TEN[frac_part->len] + frac_part->num;
+	return true;
+}
+
+/*
+ * _to_double:
+ * @sign: 1 or -1.
+ * @int_part: The number before the decimal point.
+ * @frac_part: The number after the decimal point.
+ *
+ * Converts a decimal number that the tokenizer has already split up and scanned.
+ *
+ * When the digits and the power of ten are both exactly representable, a single division gives a
+ * correctly rounded result (Clinger's fast path). As SDL numbers never have an exponent, this covers
+ * nearly everything; the rest go through g_ascii_strtod().
+ *
+ * Returns: The closest double to the number, which may be infinite.
+ */
+static double _to_double(int sign, GSDLToken *int_part, GSDLToken *frac_part) {
+	guint64 mantissa;
+
+	if (_mantissa(int_part, frac_part, &mantissa) && mantissa <= (G_GUINT64_CONSTANT(1) << 53) && frac_part->len < G_N_ELEMENTS(POWERS_OF_TEN)) {
+		return sign * ((double) mantissa / POWERS_OF_TEN[frac_part->len]);
+	}
+
+	char *str = _number_string(sign, int_part, frac_part, ".");
+	double result = g_ascii_strtod(str, NULL);
+	g_free(str);
+
+	return result;
+}
+
+/*
+ * _to_float:
+ * @sign: 1 or -1.
+ * @int_part: The number before the decimal point.
+ * @frac_part: The number after the decimal point.
+ *
+ * Like _to_double(), but for floats. The slow path must not go through a double, as rounding twice
+ * can land one unit in the last place away from the closest float. There is no g_ascii_strtof(), so
+ * it uses strtof() with the locale's decimal point instead.
+ *
+ * Returns: The closest float to the number, which may be infinite.
+ */
+static float _to_float(int sign, GSDLToken *int_part, GSDLToken *frac_part) {
+	guint64 mantissa;
+
+	if (_mantissa(int_part, frac_part, &mantissa) && mantissa <= (1 << 24) && frac_part->len < G_N_ELEMENTS(FLOAT_POWERS_OF_TEN)) {
+		return sign * ((float) mantissa / FLOAT_POWERS_OF_TEN[frac_part->len]);
+	}
+
+	char *str = _number_string(sign, int_part, frac_part, localeconv()->decimal_point);
+	float result = strtof(str, NULL);
+	g_free(str);
+
+	return result;
+}
+
 //> Parser Functions
 static bool _token_is_value(GSDLToken *token) {
 	switch ((int) token->type) {
@@ -224,47 +620,41 @@ static bool _token_is_value(GSDLToken *token) {
 	}
 }
 
-static bool _parse_number(GSDLParserContext *self, GValue *value, GSDLToken *token, int sign) {
-	char *end;
-	GSDLToken *next, *parts[1];
-
-	if (token->type == T_LONGINTEGER) {
-		g_value_init(value, G_TYPE_INT64);
-		errno = 0;
-		g_value_set_int64(value, sign * strtoll(token->val, &end, 10));
+static bool _parse_number(GSDLParserContext *self, GValue *value, GSDLToken token, int sign) {
+	GSDLToken next, int_part;
+	// The most negative number of each type is one further from zero than the most positive.
+	guint64 neg = sign < 0 ? 1 : 0;
 
-		if (errno) {
-			_error(self, token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Long integer out of range");
+	if (token.type == T_LONGINTEGER) {
+		if (token.num > (guint64) G_MAXINT64 + neg) {
+			_error(self, &token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Long integer out of range");
 
 			return false;
 		}
 
-		gsdl_token_free(token);
+		g_value_init(value, G_TYPE_INT64);
+		g_value_set_int64(value, sign < 0 ? (gint64) -token.num : (gint64) token.num);
+
 		return true;
 	}
 
 	REQUIRE(_peek(self, &next));
 
-	if (next->type == '.') {
+	if (next.type == '.') {
 		_consume(self);
-		gsdl_token_free(next);
-		parts[0] = token;
+		int_part = token;
 
 		REQUIRE(_read(self, &token));
 		EXPECT(T_NUMBER, T_FLOAT_END, T_DOUBLE_END, T_DECIMAL_END);
 
-		char *total = g_strdup_printf("%s%s.%s", sign <= 0 ? "-" : "", parts[0]->val, token->val);
-		gsdl_token_free(parts[0]);
-
-		switch (token->type) {
+		switch (token.type) {
 			case T_NUMBER:
 			case T_DOUBLE_END:
 				g_value_init(value, G_TYPE_DOUBLE);
+				g_value_set_double(value, _to_double(sign, &int_part, &token));
 
-				g_value_set_double(value, strtod(total, &end));
-
-				if (*end) {
-					_error(self, token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Double out of range");
+				if (isinf(g_value_get_double(value))) {
+					_error(self, &token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Double out of range");
 
 					return false;
 				}
@@ -273,11 +663,10 @@ static bool _parse_number(GSDLParserContext *self, GValue *value, GSDLToken *tok
 
 			case T_FLOAT_END:
 				g_value_init(value, G_TYPE_FLOAT);
+				g_value_set_float(value, _to_float(sign, &int_part, &token));
 
-				g_value_set_float(value, strtof(total, &end));
-
-				if (*end) {
-					_error(self, token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Float out of range");
+				if (isinf(g_value_get_float(value))) {
+					_error(self, &token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Float out of range");
 
 					return false;
 				}
@@ -286,147 +675,132 @@ static bool _parse_number(GSDLParserContext *self, GValue *value, GSDLToken *tok
 			case T_DECIMAL_END:
 				g_value_init(value, GSDL_TYPE_DECIMAL);
 
-				gsdl_gvalue_set_decimal(value, total);
+				gsdl_gvalue_take_decimal(value, _number_string(sign, &int_part, &token, "."));
 
 				break;
 			default:
 				g_return_val_if_reached(false);
 		}
-
-		g_free(total);
-	} else {
+	} else if (token.num <= (guint64) G_MAXINT + neg) {
 		g_value_init(value, G_TYPE_INT);
-		g_value_set_int(value, sign * strtol(token->val, &end, 10));
+		g_value_set_int(value, sign < 0 ? (gint) -token.num : (gint) token.num);
+	} else if (token.num <= (guint64) G_MAXINT64 + neg) {
+		// Too big for an int, but we can still represent it faithfully.
+		g_value_init(value, G_TYPE_INT64);
+		g_value_set_int64(value, sign < 0 ? (gint64) -token.num : (gint64) token.num);
+	} else {
+		_error(self, &token, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Integer out of range");
+
+		return false;
 	}
 
-	gsdl_token_free(token);
 	return true;
 }
 
-static bool _parse_timezone(GSDLParserContext *self, GTimeZone **timezone, GSDLToken *first) {
+static bool _parse_timezone(GSDLParserContext *self, GTimeZone **timezone, GSDLToken first) {
 	GString *identifier = g_string_new("");
-	GSDLToken *token;
+	GSDLToken token;
 
-	if (strcmp(first->val, "GMT") == 0) {
+	if (_token_equal(&first, "GMT")) {
 		REQUIRE(_read(self, &token));
 		EXPECT('+', '-');
-		g_string_append_c(identifier, (gchar) token->type);
-		gsdl_token_free(token);
+		g_string_append_c(identifier, (gchar) token.type);
 
 		REQUIRE(_read(self, &token));
 		EXPECT(T_NUMBER, T_TIME_PART);
 
-		if (token->type == T_NUMBER) {
-			int val = atoi(token->val);
+		if (token.type == T_NUMBER) {
+			int val = _token_to_int(&token);
 			g_string_append_printf(identifier, "%02d%02d", val / 100 % 100, val % 100);
-			gsdl_token_free(token);
 		} else {
-			g_string_append_printf(identifier, "%02d", atoi(token->val));
-			gsdl_token_free(token);
+			g_string_append_printf(identifier, "%02d", _token_to_int(&token));
 
 			REQUIRE(_read(self, &token));
 			EXPECT(T_NUMBER);
-			g_string_append_printf(identifier, "%02d", atoi(token->val));
-			gsdl_token_free(token);
+			g_string_append_printf(identifier, "%02d", _token_to_int(&token));
 		}
 	} else {
-		g_string_append(identifier, first->val);
+		g_string_append_len(identifier, first.val, first.len);
 
 		REQUIRE(_peek(self, &token));
 
-		if (token->type == '/') {
+		if (token.type == '/') {
 			_consume(self);
 			g_string_append_c(identifier, '/');
-			gsdl_token_free(token);
 
 			REQUIRE(_read(self, &token));
 			EXPECT(T_IDENTIFIER);
-			g_string_append(identifier, token->val);
-			gsdl_token_free(token);
+			g_string_append_len(identifier, token.val, token.len);
 		}
 	}
 
 	*timezone = g_time_zone_new(identifier->str);
 
 	if (!*timezone) {
-		_error(self, first, GSDL_SYNTAX_ERROR_BAD_LITERAL, g_strdup_printf("Unknown timezone in date/time: %s", identifier->str));
+		_error(self, &first, GSDL_SYNTAX_ERROR_BAD_LITERAL, g_strdup_printf("Unknown timezone in date/time: %s", identifier->str));
 	}
 
 	g_string_free(identifier, TRUE);
-	gsdl_token_free(first);
 
-	return true;
+	return *timezone != NULL;
 }
 
-static bool _parse_datetime(GSDLParserContext *self, GValue *value, GSDLToken *token) {
-	GSDLToken *next, *first;
+static bool _parse_datetime(GSDLParserContext *self, GValue *value, GSDLToken token) {
+	GSDLToken next, first;
 	double part_nums[8];
 
 	first = token;
-	part_nums[0] = atoi(first->val);
+	part_nums[0] = _token_to_int(&first);
 
 	REQUIRE(_read(self, &token));
 	EXPECT(T_DATE_PART);
-	part_nums[1] = atoi(token->val);
-	gsdl_token_free(token);
+	part_nums[1] = _token_to_int(&token);
 
 	REQUIRE(_read(self, &token));
 	EXPECT(T_NUMBER);
-	part_nums[2] = atof(token->val);
-	gsdl_token_free(token);
+	part_nums[2] = _token_to_int(&token);
 
 	if (!g_date_valid_dmy(part_nums[2], part_nums[1], part_nums[0])) {
-		_error(self, first, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Invalid date");
+		_error(self, &first, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Invalid date");
 
 		return false;
 	}
 
 	REQUIRE(_peek(self, &next));
 
-	if (next->type == T_TIME_PART) {
+	if (next.type == T_TIME_PART) {
 		g_value_init(value, GSDL_TYPE_DATETIME);
 
 		_consume(self);
-		part_nums[3] = atoi(next->val);
-		gsdl_token_free(next);
+		part_nums[3] = _token_to_int(&next);
 
 		REQUIRE(_read(self, &token));
 		EXPECT(T_NUMBER, T_TIME_PART);
-		part_nums[4] = atoi(token->val);
+		part_nums[4] = _token_to_int(&token);
 
-		if (token->type == T_NUMBER) {
-			gsdl_token_free(token);
+		if (token.type == T_NUMBER) {
 			part_nums[5] = 0;
 		} else {
-			gsdl_token_free(token);
 			REQUIRE(_read(self, &token));
 			EXPECT(T_NUMBER);
 			REQUIRE(_peek(self, &next));
 
-			if (next->type == '.') {
+			if (next.type == '.') {
 				_consume(self);
-				gsdl_token_free(next);
 
 				REQUIRE(_read(self, &next));
-				char *total = g_strdup_printf("%s.%s", token->val, next->val);
-
-				part_nums[5] = atof(total);
-
-				g_free(total);
+				part_nums[5] = _to_double(1, &token, &next);
 			} else {
-				part_nums[5] = atoi(token->val);
+				part_nums[5] = _token_to_int(&token);
 			}
-
-			gsdl_token_free(token);
 		}
 
 		GTimeZone *timezone;
 
 		REQUIRE(_peek(self, &next));
 
-		if (next->type == '-') {
+		if (next.type == '-') {
 			_consume(self);
-			gsdl_token_free(next);
 			
 			REQUIRE(_read(self, &token));
 			EXPECT(T_IDENTIFIER);
@@ -438,7 +812,7 @@ static bool _parse_datetime(GSDLParserContext *self, GValue *value, GSDLToken *t
 		GDateTime *datetime = g_date_time_new(timezone, part_nums[0], part_nums[1], part_nums[2], part_nums[3], part_nums[4], part_nums[5]);
 
 		if (!datetime) {
-			_error(self, first, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Invalid time in date/time");
+			_error(self, &first, GSDL_SYNTAX_ERROR_BAD_LITERAL, "Invalid time in date/time");
 
 			return false;
 		}
@@ -456,43 +830,38 @@ static bool _parse_datetime(GSDLParserContext *self, GValue *value, GSDLToken *t
 	return true;
 }
 
-static bool _parse_timespan(GSDLParserContext *self, GValue *value, GSDLToken *token, int sign) {
-	GSDLToken *next, *first;
+static bool _parse_timespan(GSDLParserContext *self, GValue *value, GSDLToken token, int sign) {
+	GSDLToken next, first;
 	int part_nums[5];
 
 	first = token;
 
-	if (first->type == T_DAYS) {
-		part_nums[0] = atoi(first->val);
+	if (first.type == T_DAYS) {
+		part_nums[0] = _token_to_int(&first);
 
 		REQUIRE(_read(self, &token));
 		EXPECT(T_TIME_PART);
-		part_nums[1] = atoi(token->val);
-		gsdl_token_free(token);
+		part_nums[1] = _token_to_int(&token);
 	} else {
 		part_nums[0] = 0;
-		part_nums[1] = atoi(token->val);
+		part_nums[1] = _token_to_int(&token);
 	}
 
 	REQUIRE(_read(self, &token));
 	EXPECT(T_TIME_PART);
-	part_nums[2] = atoi(token->val);
-	gsdl_token_free(token);
+	part_nums[2] = _token_to_int(&token);
 
 	REQUIRE(_read(self, &token));
 	EXPECT(T_NUMBER);
-	part_nums[3] = atof(token->val);
-	gsdl_token_free(token);
+	part_nums[3] = _token_to_int(&token);
 
 	REQUIRE(_peek(self, &next));
 
-	if (next->type == '.') {
+	if (next.type == '.') {
 		_consume(self);
-		gsdl_token_free(next);
 
 		REQUIRE(_read(self, &token));
-		part_nums[4] = atoi(token->val);
-		gsdl_token_free(token);
+		part_nums[4] = _token_to_int(&token);
 	} else {
 		part_nums[4] = 0;
 	}
@@ -506,21 +875,19 @@ static bool _parse_timespan(GSDLParserContext *self, GValue *value, GSDLToken *t
 		part_nums[4] * G_TIME_SPAN_MILLISECOND
 	));
 
-	gsdl_token_free(first);
 	return true;
 }
 
 static bool _parse_value(GSDLParserContext *self, GValue *value) {
-	GSDLToken *token;
+	GSDLToken token;
 	REQUIRE(_read(self, &token));
 
 	int sign = 1;
 	
 	retry:
-	switch ((int) token->type) {
+	switch ((int) token.type) {
 		case '-':
 			sign = -1;
-			gsdl_token_free(token);
 
 			REQUIRE(_read(self, &token));
 			EXPECT(T_NUMBER, T_LONGINTEGER, T_DAYS, T_TIME_PART);
@@ -541,9 +908,9 @@ static bool _parse_value(GSDLParserContext *self, GValue *value) {
 		case T_BOOLEAN:
 			g_value_init(value, G_TYPE_BOOLEAN);
 
-			if (strcmp(token->val, "true") == 0 || strcmp(token->val, "on") == 0) {
+			if (_token_equal(&token, "true") || _token_equal(&token, "on")) {
 				g_value_set_boolean(value, TRUE);
-			} else if (strcmp(token->val, "false") == 0 || strcmp(token->val, "off") == 0) {
+			} else if (_token_equal(&token, "false") || _token_equal(&token, "off")) {
 				g_value_set_boolean(value, FALSE);
 			}
 
@@ -556,20 +923,22 @@ static bool _parse_value(GSDLParserContext *self, GValue *value) {
 
 		case T_STRING:
 			g_value_init(value, G_TYPE_STRING);
-			g_value_set_string(value, token->val);
+			g_value_take_string(value, g_strndup(token.val, token.len));
 			break;
 
 		case T_CHAR:
 			g_value_init(value, GSDL_TYPE_UNICHAR);
-			gsdl_gvalue_set_unichar(value, g_utf8_get_char(token->val));
+			gsdl_gvalue_set_unichar(value, g_utf8_get_char(token.val));
 			break;
 
 		case T_BINARY:
 			g_value_init(value, GSDL_TYPE_BINARY);
 
-			gsize len;
-			guchar *data = g_base64_decode(token->val, &len);
-			gsdl_gvalue_take_binary(value, g_byte_array_new_take(data, len));
+			// The tokenizer has already decoded the data into a buffer we can take over.
+			guchar *data = (guchar*) _gsdl_tokenizer_steal_value(self->tokenizer, &token);
+			if (!data) data = memcpy(g_malloc(token.len), token.val, token.len);
+
+			gsdl_gvalue_take_binary(value, g_byte_array_new_take(data, token.len));
 
 			break;
 
@@ -577,265 +946,1251 @@ static bool _parse_value(GSDLParserContext *self, GValue *value) {
 			g_return_val_if_reached(false);
 	}
 
-	gsdl_token_free(token);
 	return true;
 }
 
-static void _str_ptr_unset(gchar **value) {
-	g_free(*value);
+//> Scratch Vectors
+static gpointer EMPTY_VECTOR[1] = { NULL };
+
+static void _vector_append(ScratchVector *vector, gpointer item) {
+	if (G_UNLIKELY(vector->len + 1 >= vector->alloc)) {
+		vector->alloc = MAX(8, vector->alloc * 2);
+		vector->items = g_renew(gpointer, vector->items, vector->alloc);
+	}
+
+	vector->items[vector->len++] = item;
+	vector->items[vector->len] = NULL;
 }
 
-static void _value_ptr_unset(GValue **value) {
-	g_value_unset(*value);
+static gpointer* _vector_data(ScratchVector *vector) {
+	return vector->len ? vector->items : EMPTY_VECTOR;
 }
 
-static bool _parse_tag(GSDLParserContext *self) {
-	GSDLToken *first, *token;
-	char *name = g_strdup("content");
+/*
+ * _vector_point_to:
+ * @vector: A #ScratchVector to fill.
+ * @block: A #ValueBlock.
+ *
+ * Returns: A %NULL-terminated array of pointers to the values in @block.
+ */
+static GValue** _vector_point_to(ScratchVector *vector, ValueBlock *block) {
+	vector->len = 0;
+	for (guint i = 0; i < block->len; i++) _vector_append(vector, &block->items[i]);
 
-	GArray *values = g_array_new(TRUE, FALSE, sizeof(GValue*));
-	GArray *attr_names = g_array_new(TRUE, FALSE, sizeof(gchar*));
-	GArray *attr_values = g_array_new(TRUE, FALSE, sizeof(GValue*));
+	return (GValue**) _vector_data(vector);
+}
 
-	g_array_set_clear_func(values, (GDestroyNotify) _value_ptr_unset);
-	g_array_set_clear_func(attr_names, (GDestroyNotify) _str_ptr_unset);
-	g_array_set_clear_func(attr_values, (GDestroyNotify) _value_ptr_unset);
+//> Value Blocks
+static GValue* _block_append(ValueBlock *block) {
+	if (G_UNLIKELY(block->len == block->alloc)) {
+		block->alloc = MAX(8, block->alloc * 2);
+		block->items = g_renew(GValue, block->items, block->alloc);
+	}
 
-	REQUIRE(_peek(self, &first));
+	GValue *value = &block->items[block->len++];
+	memset(value, 0, sizeof(GValue));
 
-	if (first->type == T_IDENTIFIER) {
-		_consume(self);
+	return value;
+}
 
-		REQUIRE(_peek(self, &token));
+static void _block_unset(ValueBlock *block) {
+	for (guint i = 0; i < block->len; i++) {
+		// The last value may not have been initialized, if parsing it failed.
+		if (G_IS_VALUE(&block->items[i])) g_value_unset(&block->items[i]);
+	}
 
-		if (token->type == '=') {
-			_error(
-				self,
-				first,
-				GSDL_SYNTAX_ERROR_MALFORMED,
-				"At least one value required for an anonymous tag"
-			);
+	block->len = 0;
+}
 
-			return false;
-		}
+//> Lazy Values
+/*
+ * _keep:
+ * @self: A valid #GSDLParserContext.
+ * @token: A token that is part of a lazy value.
+ *
+ * Saves a token for when its value is decoded.
+ */
+static void _keep(GSDLParserContext *self, GSDLToken *token) {
+	// Only strings and binary literals can have values that were copied out of the input.
+	if (token->type == T_STRING || token->type == T_BINARY) {
+		char *owned = _gsdl_tokenizer_steal_value(self->tokenizer, token);
+		if (owned) _vector_append(&self->lazy_owned, owned);
+	}
 
-		g_free(name);
-		name = g_strdup(first->val);
-		gsdl_token_free(first);
-	} else {
-		token = first;
+	g_array_append_val(self->lazy_tokens, *token);
+}
 
-		EXPECT(T_IDENTIFIER, T_NUMBER, T_TIME_PART, T_DATE_PART, T_LONGINTEGER, T_DAYS, T_BOOLEAN, T_NULL, T_STRING, T_CHAR, T_BINARY);
-	}
+static bool _read_kept(GSDLParserContext *self, GSDLToken *token) {
+	REQUIRE(_read(self, token));
+	_keep(self, token);
 
-	bool peek_success = true;
+	return true;
+}
 
-	while ((_peek(self, &token) || (peek_success = false)) && _token_is_value(token)) {
-		GValue *value = g_slice_new0(GValue);
-		REQUIRE(_parse_value(self, value));
-		g_array_append_val(values, value);
-	}
-	REQUIRE(peek_success);
+static void _consume_kept(GSDLParserContext *self, GSDLToken *token) {
+	_consume(self);
+	_keep(self, token);
+}
 
-	while ((_peek(self, &token) || (peek_success = false)) && token->type == T_IDENTIFIER) {
-		_consume(self);
-		char *contents = g_strdup(token->val);
-		g_array_append_val(attr_names, contents);
-		gsdl_token_free(token);
+/*
+ * _skip_timezone:
+ * @self: A valid #GSDLParserContext.
+ * @token: The first part of the timezone's name.
+ *
+ * Reads the same tokens as _parse_timezone(), without looking up the timezone.
+ */
+static bool _skip_timezone(GSDLParserContext *self, GSDLToken token) {
+	if (_token_equal(&token, "GMT")) {
+		REQUIRE(_read_kept(self, &token));
+		EXPECT('+', '-');
 
-		REQUIRE(_read(self, &token));
-		EXPECT('=');
-		gsdl_token_free(token);
+		REQUIRE(_read_kept(self, &token));
+		EXPECT(T_NUMBER, T_TIME_PART);
 
-		GValue *value = g_slice_new0(GValue);
-		REQUIRE(_parse_value(self, value));
-		g_array_append_val(attr_values, value);
-	}
-	REQUIRE(peek_success);
+		if (token.type == T_TIME_PART) {
+			REQUIRE(_read_kept(self, &token));
+			EXPECT(T_NUMBER);
+		}
+	} else {
+		REQUIRE(_peek(self, &token));
 
-	GError *err = NULL;
-	MAYBE_CALLBACK(self->parser->start_tag,
-		self,
-		name,
-		(GValue**) values->data,
-		(gchar**) attr_names->data,
-		(GValue**) attr_values->data,
-		self->user_data,
-		&err
-	);
-	if (err) {
-		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
-		return false;
+		if (token.type == '/') {
+			_consume_kept(self, &token);
+
+			REQUIRE(_read_kept(self, &token));
+			EXPECT(T_IDENTIFIER);
+		}
 	}
 
-	g_array_free(values, TRUE);
-	g_array_free(attr_names, TRUE);
-	g_array_free(attr_values, TRUE);
+	return true;
+}
 
-	REQUIRE(_peek(self, &token));
+/*
+ * _skip_datetime:
+ * @self: A valid #GSDLParserContext.
+ * @ref: The #GSDLValueRef being filled in.
+ *
+ * Reads the same tokens as _parse_datetime(), after the first.
+ */
+static bool _skip_datetime(GSDLParserContext *self, GSDLValueRef *ref) {
+	GSDLToken token, next;
 
-	if (token->type == '{') {
-		_consume(self);
-		gsdl_token_free(token);
+	REQUIRE(_read_kept(self, &token));
+	EXPECT(T_DATE_PART);
 
-		while ((_peek(self, &token) || (peek_success = false)) && token->type != '}') {
-			if (token->type == '\n') {
-				_consume(self);
-				continue;
-			}
+	REQUIRE(_read_kept(self, &token));
+	EXPECT(T_NUMBER);
 
-			REQUIRE(_parse_tag(self));
-			REQUIRE(_peek(self, &token));
-			EXPECT('\n', ';', '}');
+	REQUIRE(_peek(self, &next));
 
-			if (token->type != '}') {
-				_consume(self);
-				gsdl_token_free(token);
-			}
-		}
+	if (next.type != T_TIME_PART) {
+		ref->type = GSDL_TYPE_DATE;
 
-		EXPECT('}');
-		_consume(self);
-		gsdl_token_free(token);
+		return true;
 	}
 
-	err = NULL;
-	MAYBE_CALLBACK(self->parser->end_tag,
-		self,
-		name,
-		self->user_data,
-		&err
-	);
-	if (err) {
-		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
-		return false;
-	}
+	ref->type = GSDL_TYPE_DATETIME;
+	_consume_kept(self, &next);
 
-	return true;
-}
+	REQUIRE(_read_kept(self, &token));
+	EXPECT(T_NUMBER, T_TIME_PART);
 
-extern void _gsdl_types_init();
+	if (token.type == T_TIME_PART) {
+		REQUIRE(_read_kept(self, &token));
+		EXPECT(T_NUMBER);
+		REQUIRE(_peek(self, &next));
 
-static bool _parse(GSDLParserContext *self) {
-	_gsdl_types_init();
+		if (next.type == '.') {
+			_consume_kept(self, &next);
+			REQUIRE(_read_kept(self, &next));
+		}
+	}
 
-	GSDLToken *token;
-	for (;;) {
-		REQUIRE(_peek(self, &token));
+	REQUIRE(_peek(self, &next));
+
+	if (next.type == '-') {
+		_consume_kept(self, &next);
+
+		REQUIRE(_read_kept(self, &token));
+		EXPECT(T_IDENTIFIER);
+		REQUIRE(_skip_timezone(self, token));
+	}
+
+	return true;
+}
+
+/*
+ * _skip_timespan:
+ * @self: A valid #GSDLParserContext.
+ * @token: The first token of the timespan.
+ *
+ * Reads the same tokens as _parse_timespan(), after the first.
+ */
+static bool _skip_timespan(GSDLParserContext *self, GSDLToken token) {
+	GSDLToken next;
+
+	if (token.type == T_DAYS) {
+		REQUIRE(_read_kept(self, &token));
+		EXPECT(T_TIME_PART);
+	}
+
+	REQUIRE(_read_kept(self, &token));
+	EXPECT(T_TIME_PART);
+
+	REQUIRE(_read_kept(self, &token));
+	EXPECT(T_NUMBER);
+
+	REQUIRE(_peek(self, &next));
+
+	if (next.type == '.') {
+		_consume_kept(self, &next);
+		REQUIRE(_read_kept(self, &next));
+	}
+
+	return true;
+}
 
-		if (token->type == T_EOF) {
+/*
+ * _skip_value:
+ * @self: A valid #GSDLParserContext.
+ * @ref: (out caller-allocates): The #GSDLValueRef to fill in.
+ *
+ * Checks the syntax of a value and works out its type, keeping its tokens for
+ * gsdl_parser_context_decode(). This must read exactly the same tokens as _parse_value().
+ *
+ * Returns: Whether the value's syntax was correct.
+ */
+static bool _skip_value(GSDLParserContext *self, GSDLValueRef *ref) {
+	GSDLToken token, next;
+	guint64 neg = 0;
+
+	ref->_first_token = self->lazy_tokens->len;
+
+	REQUIRE(_read_kept(self, &token));
+	ref->offset = token.offset;
+
+	if (token.type == '-') {
+		neg = 1;
+
+		REQUIRE(_read_kept(self, &token));
+		EXPECT(T_NUMBER, T_LONGINTEGER, T_DAYS, T_TIME_PART);
+	}
+
+	switch ((int) token.type) {
+		case T_LONGINTEGER:
+			ref->type = G_TYPE_INT64;
 			break;
-		} else if (token->type == '\n' || token->type == ';') {
-			_consume(self);
-			continue;
+
+		case T_NUMBER:
+			REQUIRE(_peek(self, &next));
+
+			if (next.type == '.') {
+				_consume_kept(self, &next);
+
+				REQUIRE(_read_kept(self, &token));
+				EXPECT(T_NUMBER, T_FLOAT_END, T_DOUBLE_END, T_DECIMAL_END);
+
+				ref->type = token.type == T_FLOAT_END ? G_TYPE_FLOAT : token.type == T_DECIMAL_END ? GSDL_TYPE_DECIMAL : G_TYPE_DOUBLE;
+			} else {
+				// Numbers out of range for an int64 are only noticed when decoded.
+				ref->type = token.num <= (guint64) G_MAXINT + neg ? G_TYPE_INT : G_TYPE_INT64;
+			}
+
+			break;
+
+		case T_DATE_PART:
+			REQUIRE(_skip_datetime(self, ref));
+			break;
+
+		case T_DAYS:
+		case T_TIME_PART:
+			REQUIRE(_skip_timespan(self, token));
+			ref->type = GSDL_TYPE_TIMESPAN;
+			break;
+
+		case T_BOOLEAN: ref->type = G_TYPE_BOOLEAN; break;
+		case T_NULL: ref->type = G_TYPE_POINTER; break;
+		case T_STRING: ref->type = G_TYPE_STRING; break;
+		case T_CHAR: ref->type = GSDL_TYPE_UNICHAR; break;
+		case T_BINARY: ref->type = GSDL_TYPE_BINARY; break;
+
+		default:
+			g_return_val_if_reached(false);
+	}
+
+	// Anything that _parse_value() might peek at after the value will not look like part of it.
+	GSDLToken sentinel = { .type = '\n', .offset = token.offset };
+	g_array_append_val(self->lazy_tokens, sentinel);
+	ref->_n_tokens = self->lazy_tokens->len - ref->_first_token;
+
+	return true;
+}
+
+static GSDLValueRef* _ref_append(GArray *refs) {
+	g_array_set_size(refs, refs->len + 1);
+
+	return &g_array_index(refs, GSDLValueRef, refs->len - 1);
+}
+
+static void _lazy_clear(GSDLParserContext *self) {
+	g_array_set_size(self->value_refs, 0);
+	g_array_set_size(self->attr_refs, 0);
+	g_array_set_size(self->lazy_tokens, 0);
+
+	for (gsize i = 0; i < self->lazy_owned.len; i++) g_free(self->lazy_owned.items[i]);
+	self->lazy_owned.len = 0;
+}
+
+/**
+ * gsdl_parser_context_decode:
+ * @self: A valid #GSDLParserContext.
+ * @ref: A value handle passed to the current start_tag_lazy callback.
+ * @value: A zero-filled #GValue to store the value in. It must be unset by the caller.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Fully parses a value handed to the %start_tag_lazy callback. This may only be called from within
+ * that callback (or, for values from a #GSDLReader, until the next event is read), and may be
+ * called any number of times for the same value.
+ *
+ * Returns: Whether the value could be decoded. Errors are only reported through @err; the %error
+ *          callback is not called.
+ */
+bool gsdl_parser_context_decode(GSDLParserContext *self, const GSDLValueRef *ref, GValue *value, GError **err) {
+	g_return_val_if_fail(!self->decode_err && ref->_first_token + ref->_n_tokens <= self->lazy_tokens->len, false);
+
+	GError *decode_err = NULL;
+	gsize token_pos = self->token_pos, token_count = self->token_count;
+
+	self->token_buf = &g_array_index(self->lazy_tokens, GSDLToken, ref->_first_token);
+	self->token_pos = 0;
+	self->token_count = ref->_n_tokens;
+	self->decode_err = &decode_err;
+
+	bool success = _parse_value(self, value);
+
+	self->token_buf = self->tokens;
+	self->token_pos = token_pos;
+	self->token_count = token_count;
+	self->decode_err = NULL;
+
+	if (!success) g_propagate_error(err, decode_err);
+
+	return success;
+}
+
+//> Projections
+static ProjectionNode* _projection_new(const char *name) {
+	ProjectionNode *node = g_slice_new0(ProjectionNode);
+	node->name = g_strdup(name);
+	node->children = g_ptr_array_new();
+
+	return node;
+}
+
+static void _projection_free(ProjectionNode *node) {
+	for (guint i = 0; i < node->children->len; i++) _projection_free(g_ptr_array_index(node->children, i));
+	g_ptr_array_free(node->children, TRUE);
+
+	if (node->attrs) {
+		for (guint i = 0; i < node->attrs->len; i++) g_free(g_ptr_array_index(node->attrs, i));
+		g_ptr_array_free(node->attrs, TRUE);
+	}
+
+	g_free(node->name);
+	g_slice_free(ProjectionNode, node);
+}
+
+/**
+ * gsdl_parser_context_add_projection:
+ * @self: A valid #GSDLParserContext.
+ * @path: A list of tag names separated by '/', any of which can be '*' to match any tag. May end
+ *        with one or more attribute names, each after an '@'; for example,
+ *        "server/listener@host@port" or "cluster/&ast;/node".
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Limits the tags passed to the callbacks to those matching @path, or any other projection that has
+ * been added. start_tag and end_tag are only called for matching tags, and if @path ends with
+ * attribute names, only those attributes are decoded and passed to start_tag; the others are only
+ * checked for correct syntax.
+ *
+ * All other tags are skipped over without being tokenized, as with
+ * gsdl_parser_context_skip_children(), other than the names of the tags leading to a match.
+ * Errors inside them (other than missing braces) are never noticed.
+ *
+ * Projections last until gsdl_parser_context_clear_projections() is called, and must not be
+ * changed during a parse.
+ *
+ * Returns: Whether @path was valid. If not, the error will be %GSDL_SYNTAX_ERROR_BAD_PATH.
+ */
+bool gsdl_parser_context_add_projection(GSDLParserContext *self, const char *path, GError **err) {
+	GSDLPath *parsed = _gsdl_path_parse(path, err);
+	REQUIRE(parsed);
+
+	// Whether to skip a tag is decided as soon as its name is read, before its attributes.
+	for (guint i = 0; i < parsed->n_steps; i++) {
+		if (parsed->steps[i].n_preds) {
+			g_set_error(err,
+				GSDL_SYNTAX_ERROR,
+				GSDL_SYNTAX_ERROR_BAD_PATH,
+				"Projections cannot check attribute values, in path \"%s\"",
+				path
+			);
+			_gsdl_path_free(parsed);
+
+			return false;
+		}
+	}
+
+	if (!self->projection) self->projection = _projection_new(NULL);
+
+	ProjectionNode *node = self->projection;
+
+	for (guint i = 0; i < parsed->n_steps; i++) {
+		const char *name = parsed->steps[i].name;
+		ProjectionNode *next = NULL;
+
+		for (guint j = 0; j < node->children->len && !next; j++) {
+			ProjectionNode *child = g_ptr_array_index(node->children, j);
+			if (g_strcmp0(child->name, name) == 0) next = child;
+		}
+
+		if (!next) {
+			next = _projection_new(name);
+			g_ptr_array_add(node->children, next);
+		}
+
+		node = next;
+	}
+
+	if (!parsed->attrs) {
+		// Picking out every attribute wins over picking out a few.
+		if (node->attrs) {
+			for (guint i = 0; i < node->attrs->len; i++) g_free(g_ptr_array_index(node->attrs, i));
+			g_ptr_array_free(node->attrs, TRUE);
+			node->attrs = NULL;
+		}
+	} else if (node->attrs || !node->match) {
+		if (!node->attrs) node->attrs = g_ptr_array_new();
+		for (char **attr = parsed->attrs; *attr; attr++) g_ptr_array_add(node->attrs, g_strdup(*attr));
+	}
+
+	node->match = true;
+	_gsdl_path_free(parsed);
+
+	return true;
+}
+
+/**
+ * gsdl_parser_context_clear_projections:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Removes all projections added with gsdl_parser_context_add_projection(), so that every tag is
+ * parsed again.
+ */
+void gsdl_parser_context_clear_projections(GSDLParserContext *self) {
+	if (self->projection) _projection_free(self->projection);
+	self->projection = NULL;
+}
+
+/*
+ * _projection_advance:
+ * @self: A valid #GSDLParserContext.
+ * @name: The name of the tag being started.
+ *
+ * Pushes the projection nodes reached by a new tag onto projection_states, after those reached by
+ * its parent.
+ *
+ * Returns: Whether any of those nodes ends a projection; that is, whether the tag should be passed
+ *          to the callbacks.
+ */
+static bool _projection_advance(GSDLParserContext *self, const char *name) {
+	GPtrArray *states = self->projection_states;
+	guint start = self->open_tags->len ? g_array_index(self->open_tags, OpenTag, self->open_tags->len - 1).states_start : 0;
+	guint end = states->len;
+	bool match = false;
+
+	for (guint i = start; i < end; i++) {
+		ProjectionNode *node = g_ptr_array_index(states, i);
+
+		for (guint j = 0; j < node->children->len; j++) {
+			ProjectionNode *child = g_ptr_array_index(node->children, j);
+			if (child->name && strcmp(child->name, name) != 0) continue;
+
+			g_ptr_array_add(states, child);
+			match |= child->match;
+		}
+	}
+
+	return match;
+}
+
+/*
+ * _projection_wants_attr:
+ * @self: A valid #GSDLParserContext.
+ * @tag: The tag being started.
+ * @name: The name of one of its attributes.
+ *
+ * Returns: Whether any projection matching the tag picks out the attribute.
+ */
+static bool _projection_wants_attr(GSDLParserContext *self, const OpenTag *tag, GSDLToken *name) {
+	if (!self->projection) return true;
+
+	for (guint i = tag->states_start; i < self->projection_states->len; i++) {
+		ProjectionNode *node = g_ptr_array_index(self->projection_states, i);
+
+		if (!node->match) continue;
+		if (!node->attrs) return true;
+
+		for (guint j = 0; j < node->attrs->len; j++) {
+			if (_token_equal(name, g_ptr_array_index(node->attrs, j))) return true;
+		}
+	}
+
+	return false;
+}
+
+//> Tag Parsing
+/*
+ * _start_skipping:
+ * @self: A valid #GSDLParserContext.
+ * @offset: Where to start skipping from, which must not be after any token that is still needed.
+ * @depth: How many blocks to skip to the end of, or 0 to skip the rest of the current tag's values
+ *         and attributes.
+ *
+ * Throws away any tokens that have been read ahead, and switches to skipping over the input without
+ * tokenizing it. See _gsdl_tokenizer_skip().
+ */
+static void _start_skipping(GSDLParserContext *self, gsize offset, guint depth) {
+	_gsdl_tokenizer_set_position(self->tokenizer, offset);
+	self->token_pos = self->token_count = 0;
+	g_clear_error(&self->token_error);
+
+	self->skip_depth = depth;
+	self->state = STATE_SKIPPING;
+}
+
+/*
+ * _parse_values:
+ * @self: A valid #GSDLParserContext.
+ * @tag: The tag being started.
+ *
+ * Parses the values and attributes of a tag into the context's value blocks, or in lazy mode, just
+ * checks their syntax. The attribute names are packed into attr_name_buf; as it may move while
+ * growing, attr_names holds offsets into it until _parse_tag_start() fixes them up. Attributes that
+ * the projections do not want are only checked, and left out entirely.
+ *
+ * Returns: Whether the values and attributes could be parsed.
+ */
+static bool _parse_values(GSDLParserContext *self, const OpenTag *tag) {
+	GSDLToken token;
+	bool peek_success = true, lazy = self->parser->start_tag_lazy != NULL;
+
+	while ((_peek(self, &token) || (peek_success = false)) && _token_is_value(&token)) {
+		if (lazy) {
+			REQUIRE(_skip_value(self, _ref_append(self->value_refs)));
 		} else {
-			REQUIRE(_parse_tag(self));
+			REQUIRE(_parse_value(self, _block_append(&self->values)));
+		}
+	}
+	REQUIRE(peek_success);
+
+	while ((_peek(self, &token) || (peek_success = false)) && token.type == T_IDENTIFIER) {
+		_consume(self);
+
+		if (!_projection_wants_attr(self, tag, &token)) {
+			GSDLValueRef ignored;
+
 			REQUIRE(_read(self, &token));
-			EXPECT('\n', ';', T_EOF);
+			EXPECT('=');
+			REQUIRE(_skip_value(self, &ignored));
+
+			continue;
+		}
+
+		_vector_append(&self->attr_names, GSIZE_TO_POINTER(self->attr_name_buf->len));
+		g_string_append_len(self->attr_name_buf, token.val, token.len);
+		g_string_append_c(self->attr_name_buf, '\0');
+
+		REQUIRE(_read(self, &token));
+		EXPECT('=');
+
+		if (lazy) {
+			REQUIRE(_skip_value(self, _ref_append(self->attr_refs)));
+		} else {
+			REQUIRE(_parse_value(self, _block_append(&self->attr_values)));
+		}
+	}
+	REQUIRE(peek_success);
+
+	return true;
+}
+
+/*
+ * _parse_tag_start:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Parses the name, values and attributes of a tag, and calls start_tag. On success, the tag is left
+ * on top of the open tag stack.
+ *
+ * If there are projections and none of them match the tag, only its name is parsed, and the parser
+ * switches to skipping the rest of it.
+ *
+ * Returns: Whether the tag could be parsed.
+ */
+static bool _parse_tag_start(GSDLParserContext *self) {
+	GSDLToken first, token;
+	OpenTag tag = { .mark = _gsdl_arena_mark(&self->arena) };
+
+	REQUIRE(_peek(self, &first));
+
+	if (first.type == T_IDENTIFIER) {
+		_consume(self);
+
+		REQUIRE(_peek(self, &token));
+
+		if (token.type == '=') {
+			_error(
+				self,
+				&first,
+				GSDL_SYNTAX_ERROR_MALFORMED,
+				"At least one value required for an anonymous tag"
+			);
+
+			return false;
+		}
+
+		tag.name = _gsdl_arena_strndup(&self->arena, first.val, first.len);
+	} else {
+		token = first;
+
+		EXPECT(T_IDENTIFIER, T_NUMBER, T_TIME_PART, T_DATE_PART, T_LONGINTEGER, T_DAYS, T_BOOLEAN, T_NULL, T_STRING, T_CHAR, T_BINARY);
+
+		tag.name = _gsdl_arena_strndup(&self->arena, "content", 7);
+	}
+
+	if (self->projection) {
+		tag.states_start = self->projection_states->len;
+		tag.hidden = !_projection_advance(self, tag.name);
+	}
+
+	if (tag.hidden) {
+		// The children only need to be parsed if some projection goes deeper.
+		self->skip_children = self->projection_states->len == tag.states_start;
+		_start_skipping(self, first.type == T_IDENTIFIER ? first.offset + first.len : first.offset, 0);
+		g_array_append_val(self->open_tags, tag);
+
+		return true;
+	}
+
+	GError *err = NULL;
+
+	self->attr_names.len = 0;
+	g_string_truncate(self->attr_name_buf, 0);
+
+	bool success = _parse_values(self, &tag);
+
+	if (success) {
+		for (gsize i = 0; i < self->attr_names.len; i++) {
+			self->attr_names.items[i] = self->attr_name_buf->str + GPOINTER_TO_SIZE(self->attr_names.items[i]);
+		}
+
+		if (self->parser->start_tag_lazy) {
+			self->parser->start_tag_lazy(
+				self,
+				tag.name,
+				(GSDLValueRef*) self->value_refs->data,
+				self->value_refs->len,
+				(gchar**) _vector_data(&self->attr_names),
+				(GSDLValueRef*) self->attr_refs->data,
+				self->attr_refs->len,
+				self->user_data,
+				&err
+			);
+		} else if (self->parser->start_tag_block) {
+			self->parser->start_tag_block(
+				self,
+				tag.name,
+				self->values.items,
+				self->values.len,
+				(gchar**) _vector_data(&self->attr_names),
+				self->attr_values.items,
+				self->attr_values.len,
+				self->user_data,
+				&err
+			);
+		} else {
+			MAYBE_CALLBACK(self->parser->start_tag,
+				self,
+				tag.name,
+				_vector_point_to(&self->value_ptrs, &self->values),
+				(gchar**) _vector_data(&self->attr_names),
+				_vector_point_to(&self->attr_value_ptrs, &self->attr_values),
+				self->user_data,
+				&err
+			);
+		}
+	}
+
+	if (!self->paused) {
+		_block_unset(&self->values);
+		_block_unset(&self->attr_values);
+		_lazy_clear(self);
+	}
+
+	if (!success) {
+		// The tag may be parsed again once more input arrives.
+		if (self->projection) g_ptr_array_set_size(self->projection_states, tag.states_start);
+
+		return false;
+	}
+
+	if (err) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+		return false;
+	}
+
+	g_array_append_val(self->open_tags, tag);
+	self->state = STATE_AFTER_HEADER;
+
+	return true;
+}
+
+/*
+ * _end_tag:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Calls end_tag for the innermost open tag (unless it is hidden by the projections), and pops it
+ * off of the open tag stack.
+ *
+ * Returns: Whether the callback succeeded.
+ */
+static bool _end_tag(GSDLParserContext *self) {
+	OpenTag tag = g_array_index(self->open_tags, OpenTag, self->open_tags->len - 1);
+	GError *err = NULL;
+
+	if (!tag.hidden) {
+		MAYBE_CALLBACK(self->parser->end_tag,
+			self,
+			tag.name,
+			self->user_data,
+			&err
+		);
+	}
+
+	g_array_set_size(self->open_tags, self->open_tags->len - 1);
+	_gsdl_arena_release(&self->arena, tag.mark);
+	if (self->projection) g_ptr_array_set_size(self->projection_states, tag.states_start);
+
+	if (err) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * _step:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Advances the parser by one statement, tag header or separator. Callbacks are only called once
+ * all of the tokens they depend on have been read, so a step that runs out of input in push mode
+ * can be safely retried from the start.
+ *
+ * Returns: Whether the step succeeded.
+ */
+static bool _step(GSDLParserContext *self) {
+	GSDLToken token;
+	gsize depth = self->open_tags->len;
+
+	switch (self->state) {
+		case STATE_STATEMENT:
+			REQUIRE(_peek(self, &token));
+
+			if (token.type == '\n' || (depth == 0 && token.type == ';')) {
+				_consume(self);
+			} else if (depth == 0 && token.type == T_EOF) {
+				self->state = STATE_DONE;
+			} else if (depth != 0 && token.type == '}') {
+				_consume(self);
+				REQUIRE(_end_tag(self));
+
+				self->state = STATE_AFTER_TAG;
+			} else if (G_UNLIKELY(self->max_depth && depth >= self->max_depth)) {
+				char msg[48];
+
+				g_snprintf(msg, sizeof(msg), "Tags nested more than %u deep", self->max_depth);
+				_error(self, &token, GSDL_SYNTAX_ERROR_TOO_DEEP, msg);
+
+				return false;
+			} else {
+				REQUIRE(_parse_tag_start(self));
+			}
+
+			break;
+
+		case STATE_AFTER_HEADER:
+			REQUIRE(_peek(self, &token));
 
-			if (token->type == T_EOF) break;
+			if (token.type == '{' && self->skip_children) {
+				self->skip_children = false;
+				_start_skipping(self, token.offset + 1, 1);
+			} else if (token.type == '{') {
+				_consume(self);
+
+				self->state = STATE_STATEMENT;
+			} else {
+				self->skip_children = false;
+				REQUIRE(_end_tag(self));
+
+				self->state = STATE_AFTER_TAG;
+			}
+
+			break;
+
+		case STATE_SKIPPING: {
+			GError *err = NULL;
+			bool values = self->skip_depth == 0;
+
+			if (!_gsdl_tokenizer_skip(self->tokenizer, &self->skip_depth, &err)) {
+				if (err) {
+					MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+				} else {
+					self->need_more = true;
+				}
+
+				return false;
+			}
+
+			if (values) {
+				self->state = STATE_AFTER_HEADER;
+			} else {
+				REQUIRE(_end_tag(self));
+
+				self->state = STATE_AFTER_TAG;
+			}
+
+			break;
+		}
+
+		case STATE_AFTER_TAG:
+			REQUIRE(_peek(self, &token));
+
+			if (depth == 0) {
+				EXPECT('\n', ';', T_EOF);
+			} else {
+				EXPECT('\n', ';', '}');
+			}
+
+			if (token.type == T_EOF) {
+				self->state = STATE_DONE;
+			} else {
+				// The end of a block is left for the next statement to pick up.
+				if (token.type != '}') _consume(self);
+
+				self->state = STATE_STATEMENT;
+			}
+
+			break;
+
+		case STATE_DONE:
+			g_return_val_if_reached(false);
+	}
+
+	return true;
+}
+
+/*
+ * _run:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Parses until the end of the input, or until a callback pauses the parse. In push mode, also
+ * stops when the input so far has run out, backing up to the start of the step that was
+ * interrupted (except when skipping, which keeps its place by itself).
+ *
+ * Returns: Whether parsing succeeded so far.
+ */
+static bool _run(GSDLParserContext *self) {
+	while (self->state != STATE_DONE && !self->paused) {
+		GSDLArenaMark mark = _gsdl_arena_mark(&self->arena);
+		gsize start = self->token_start;
+
+		if (self->feeding && self->token_pos == self->token_count) {
+			start = _gsdl_tokenizer_get_position(self->tokenizer);
+		}
+
+		if (!_step(self)) {
+			if (!self->need_more) return false;
+
+			if (self->state != STATE_SKIPPING) {
+				_gsdl_arena_release(&self->arena, mark);
+				_gsdl_tokenizer_set_position(self->tokenizer, start);
+				self->token_pos = self->token_count = 0;
+			}
+
+			self->need_more = false;
+
+			return true;
+		}
+	}
+
+	return true;
+}
+
+static void _start(GSDLParserContext *self) {
+	_gsdl_types_init();
+
+	self->token_pos = self->token_count = 0;
+	g_clear_error(&self->token_error);
+
+	g_ptr_array_set_size(self->projection_states, 0);
+	if (self->projection) g_ptr_array_add(self->projection_states, self->projection);
+
+	self->state = STATE_STATEMENT;
+}
+
+/*
+ * _finish:
+ * @self: A valid #GSDLParserContext.
+ * @success: Whether the parse succeeded.
+ *
+ * Cleans up after a parse, throwing away anything left behind by a failure. The tokenizer and the
+ * first chunk of the arena are kept around for the next parse.
+ *
+ * Returns: @success.
+ */
+static bool _finish(GSDLParserContext *self, bool success) {
+	g_array_set_size(self->open_tags, 0);
+	_gsdl_arena_reset(&self->arena);
+	self->skip_children = self->paused = false;
+
+	_block_unset(&self->values);
+	_block_unset(&self->attr_values);
+	_lazy_clear(self);
+
+	_gsdl_tokenizer_close(self->tokenizer);
+	self->token_pos = self->token_count = 0;
+	g_clear_error(&self->token_error);
+	self->feeding = self->need_more = false;
+
+	return success;
+}
+
+static bool _parse(GSDLParserContext *self) {
+	_start(self);
+
+	return _finish(self, _run(self));
+}
+
+/**
+ * gsdl_parser_context_parse_file:
+ * @self: A valid #GSDLParserContext.
+ * @filename: Path to an SDL file to parse.
+ *
+ * Returns: whether the parse succeeded.
+ */
+bool gsdl_parser_context_parse_file(GSDLParserContext *self, const char *filename) {
+	GError *err = NULL;
+
+	if (!_gsdl_tokenizer_open_file(self->tokenizer, filename, &err)) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+		return _finish(self, false);
+	}
+
+	return _parse(self);
+}
+
+
+/**
+ * gsdl_parser_context_parse_string:
+ * @self: A valid #GSDLParserContext.
+ * @str: A UTF-8 encoded string to parse.
+ *
+ * Returns: whether the parse succeeded.
+ */
+bool gsdl_parser_context_parse_string(GSDLParserContext *self, const char *str) {
+	GError *err = NULL;
+
+	if (!_gsdl_tokenizer_open_string(self->tokenizer, str, &err)) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+		return _finish(self, false);
+	}
+
+	return _parse(self);
+}
+
+/**
+ * gsdl_parser_context_feed:
+ * @self: A valid #GSDLParserContext.
+ * @buf: The next chunk of UTF-8 encoded input.
+ * @len: Length of @buf in bytes.
+ *
+ * Parses input as it arrives, for sources like pipes and sockets. @buf may end anywhere, even in
+ * the middle of a string or character; whatever cannot be parsed yet is kept until the next chunk.
+ * start_tag and end_tag are called as soon as each is complete.
+ *
+ * The first call starts a new parse, which must be finished with gsdl_parser_context_end(). @buf
+ * is copied, and does not have to stay valid after this call.
+ *
+ * Returns: whether the input so far could be parsed. Once this fails, further calls will also fail
+ *          until gsdl_parser_context_end() is called.
+ */
+bool gsdl_parser_context_feed(GSDLParserContext *self, const char *buf, gsize len) {
+	GError *err = NULL;
+
+	if (self->failed) return false;
+
+	if (!self->feeding) {
+		_gsdl_tokenizer_open_push(self->tokenizer);
+		_start(self);
+		self->feeding = true;
+	}
+
+	if (!gsdl_tokenizer_feed(self->tokenizer, buf, len, &err)) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+		self->failed = true;
+
+		return _finish(self, false);
+	}
+
+	if (!_run(self)) {
+		self->failed = true;
+
+		return _finish(self, false);
+	}
+
+	return true;
+}
+
+/**
+ * gsdl_parser_context_end:
+ * @self: A valid #GSDLParserContext.
+ *
+ * Parses whatever input is left over from gsdl_parser_context_feed(), and finishes the parse.
+ *
+ * Returns: whether the parse succeeded.
+ */
+bool gsdl_parser_context_end(GSDLParserContext *self) {
+	GError *err = NULL;
+
+	if (self->failed) {
+		self->failed = false;
+
+		return false;
+	}
+
+	// Nothing was fed in, which is the same as an empty document.
+	if (!self->feeding) return true;
+
+	self->feeding = false;
+
+	if (!gsdl_tokenizer_end(self->tokenizer, &err)) {
+		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
+
+		return _finish(self, false);
+	}
+
+	return _finish(self, _run(self));
+}
+
+//> Pulling
+/*
+ * _gsdl_parser_context_open_file:
+ * @self: A valid #GSDLParserContext.
+ * @filename: Path to an SDL file to parse.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Starts a parse that is run a piece at a time with _gsdl_parser_context_pull(), rather than all
+ * at once. The %error callback is not called if the file cannot be opened.
+ *
+ * Returns: Whether the file could be opened.
+ */
+bool _gsdl_parser_context_open_file(GSDLParserContext *self, const char *filename, GError **err) {
+	if (!_gsdl_tokenizer_open_file(self->tokenizer, filename, err)) return _finish(self, false);
 
-			gsdl_token_free(token);
-		}
-	}
+	_start(self);
 
 	return true;
 }
 
-/**
- * gsdl_parser_context_parse_file:
+/*
+ * _gsdl_parser_context_open_string:
  * @self: A valid #GSDLParserContext.
- * @filename: Path to an SDL file to parse.
+ * @str: A UTF-8 encoded string to parse, which must stay valid until the parse is finished.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
  *
- * Returns: whether the parse succeeded.
+ * As _gsdl_parser_context_open_file(), for a string.
+ *
+ * Returns: Whether @str was valid UTF-8.
  */
-bool gsdl_parser_context_parse_file(GSDLParserContext *self, const char *filename) {
-	GError *err = NULL;
-	self->tokenizer = gsdl_tokenizer_new(filename, &err);
+bool _gsdl_parser_context_open_string(GSDLParserContext *self, const char *str, GError **err) {
+	if (!_gsdl_tokenizer_open_string(self->tokenizer, str, err)) return _finish(self, false);
 
-	if (!self->tokenizer) {
-		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
-		return false;
-	}
+	_start(self);
 
-	return _parse(self);
+	return true;
 }
 
-
-/**
- * gsdl_parser_context_parse_string:
+/*
+ * _gsdl_parser_context_pause:
  * @self: A valid #GSDLParserContext.
- * @str: A UTF-8 encoded string to parse.
  *
- * Returns: whether the parse succeeded.
+ * May be called from any callback to make _gsdl_parser_context_pull() return once the callback
+ * does. If called from %start_tag_lazy, its values and attributes can still be decoded until then.
  */
-bool gsdl_parser_context_parse_string(GSDLParserContext *self, const char *str) {
-	GError *err = NULL;
-	self->tokenizer = gsdl_tokenizer_new_from_string(str, &err);
+void _gsdl_parser_context_pause(GSDLParserContext *self) {
+	self->paused = true;
+}
 
-	if (!self->tokenizer) {
-		MAYBE_CALLBACK(self->parser->error, self, err, self->user_data);
-		return false;
-	}
+/*
+ * _gsdl_parser_context_pull:
+ * @self: A #GSDLParserContext with a parse started by _gsdl_parser_context_open_file() or
+ *        _gsdl_parser_context_open_string().
+ * @done: (out): Location to store whether the parse has finished, either by reaching the end of
+ *        the input or by failing. Once it has, it must not be pulled again.
+ *
+ * Runs the parse until a callback pauses it, first throwing away anything kept from the tag that
+ * paused it last.
+ *
+ * Returns: Whether parsing succeeded so far.
+ */
+bool _gsdl_parser_context_pull(GSDLParserContext *self, bool *done) {
+	_block_unset(&self->values);
+	_block_unset(&self->attr_values);
+	_lazy_clear(self);
+	self->paused = false;
 
-	return _parse(self);
+	bool success = _run(self);
+
+	*done = !success || self->state == STATE_DONE;
+	if (*done) _finish(self, success);
+
+	return success;
 }
 
-static bool _copy_value(const gchar *tag_name, GType type, GValue *value, GValue **out_value, GError **err, const gchar *err_format, ...) {
-	bool check_type = !(GSDL_GTYPE_ANY & type), optional = !!(GSDL_GTYPE_OPTIONAL & type);
-	type &= ~(GSDL_GTYPE_OPTIONAL | GSDL_GTYPE_ANY);
+//> Value Collection
+/*
+ * CollectEntry:
+ *
+ * One value or attribute to be pulled out of a tag by gsdl_parser_collect_values(),
+ * gsdl_parser_collect_attributes() or a %GSDLCollectSpec.
+ */
+typedef struct {
+	// NULL for a value.
+	const char *name;
+	GType type;
+	bool check_type;
+	bool optional;
+
+	// For a %GSDLCollectSpec, bit i is set if SOURCE_TYPES[i] can be transformed into type.
+	bool cached;
+	guint32 transformable;
+} CollectEntry;
+
+struct _GSDLCollectSpec {
+	GArray *entries;
+
+	// Attribute names, mapped to their index in entries plus one.
+	GHashTable *attrs;
+};
 
-	va_list args;
-	va_start(args, err_format);
-	char value_id[256];
-	vsprintf(value_id, err_format, args);
-	va_end(args);
+// Every type that the parser produces values of.
+static GType SOURCE_TYPES[13];
+
+static void _source_types_init() {
+	static volatile gsize init_done = 0;
+	if (!g_once_init_enter(&init_done)) return;
+
+	_gsdl_types_init();
+
+	GType types[] = {
+		G_TYPE_INT, G_TYPE_INT64, G_TYPE_FLOAT, G_TYPE_DOUBLE, G_TYPE_BOOLEAN, G_TYPE_POINTER, G_TYPE_STRING,
+		GSDL_TYPE_DECIMAL, GSDL_TYPE_UNICHAR, GSDL_TYPE_BINARY, GSDL_TYPE_DATE, GSDL_TYPE_DATETIME, GSDL_TYPE_TIMESPAN,
+	};
+	memcpy(SOURCE_TYPES, types, sizeof(SOURCE_TYPES));
+
+	g_once_init_leave(&init_done, 1);
+}
+
+static CollectEntry _entry(const char *name, GType type) {
+	return (CollectEntry) {
+		.name = name,
+		.type = type & ~(GSDL_GTYPE_OPTIONAL | GSDL_GTYPE_ANY),
+		.check_type = !(GSDL_GTYPE_ANY & type),
+		.optional = !!(GSDL_GTYPE_OPTIONAL & type),
+	};
+}
+
+static bool _entry_transformable(const CollectEntry *entry, GType type) {
+	if (entry->cached) {
+		for (guint i = 0; i < G_N_ELEMENTS(SOURCE_TYPES); i++) {
+			if (SOURCE_TYPES[i] == type) return (entry->transformable >> i) & 1;
+		}
+	}
+
+	return g_value_type_transformable(type, entry->type);
+}
+
+/*
+ * _collect_value:
+ * @tag_name: Name of the tag, for error messages.
+ * @entry: What to collect.
+ * @index: Index of the value, for error messages; ignored for attributes.
+ * @value: (allow-none): The value or attribute found in the tag, if any.
+ * @out_value: (out): Location to store a newly allocated copy of @value, transformed to the entry's
+ *             type if needed.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Returns: Whether @value was present (or optional) and of the right type.
+ */
+static bool _collect_value(const gchar *tag_name, const CollectEntry *entry, int index, GValue *value, GValue **out_value, GError **err) {
+	char *label;
 
 	if (value == NULL) {
-		if (optional) {
+		if (entry->optional) {
 			*out_value = NULL;
 			return true;
-		} else {
-			g_set_error(
-				err,
-				GSDL_SYNTAX_ERROR,
-				GSDL_SYNTAX_ERROR_MISSING_VALUE,
-				"Tag \"%s\" requires %s",
-				tag_name,
-				value_id
-			);
-
-			return false;
 		}
+
+		label = entry->name ? g_strdup_printf("attribute \"%s\"", entry->name) : g_strdup_printf("value %d", index + 1);
+		g_set_error(
+			err,
+			GSDL_SYNTAX_ERROR,
+			GSDL_SYNTAX_ERROR_MISSING_VALUE,
+			"Tag \"%s\" requires %s",
+			tag_name,
+			label
+		);
+		g_free(label);
+
+		return false;
 	}
 
-	if (G_VALUE_TYPE(value) == type || !check_type) {
+	GType type = G_VALUE_TYPE(value);
+
+	if (type == entry->type || !entry->check_type) {
 		*out_value = g_slice_new0(GValue);
-		if (check_type) {
-			g_value_init(*out_value, type);
-		} else {
-			g_value_init(*out_value, G_VALUE_TYPE(value));
-		}
+		g_value_init(*out_value, type);
 		g_value_copy(value, *out_value);
+	} else if (_entry_transformable(entry, type)) {
+		*out_value = g_slice_new0(GValue);
+		g_value_init(*out_value, entry->type);
+		g_value_transform(value, *out_value);
 	} else {
-		if (g_value_type_transformable(G_VALUE_TYPE(value), type)) {
-			*out_value = g_slice_new0(GValue);
-			g_value_init(*out_value, type);
-			g_value_transform(value, *out_value);
-		} else {
-			g_set_error(
-				err,
-				GSDL_SYNTAX_ERROR,
-				GSDL_SYNTAX_ERROR_BAD_TYPE,
-				"Tag \"%s\" requires %s of type %s, got %s",
-				tag_name,
-				value_id,
-				g_type_name(type),
-				g_type_name(G_VALUE_TYPE(value))
-			);
+		label = entry->name ? g_strdup_printf("attribute \"%s\"", entry->name) : g_strdup_printf("value %d", index + 1);
+		g_set_error(
+			err,
+			GSDL_SYNTAX_ERROR,
+			GSDL_SYNTAX_ERROR_BAD_TYPE,
+			"Tag \"%s\" requires %s of type %s, got %s",
+			tag_name,
+			label,
+			g_type_name(entry->type),
+			g_type_name(type)
+		);
+		g_free(label);
 
-			return false;
-		}
+		return false;
 	}
 
 	return true;
@@ -848,18 +2203,13 @@ extern bool gsdl_parser_collect_values(const gchar *name, GValue* const *values,
 
 	GType type = first_type;
 	GValue **out_value = first_value;
-	int i = 1;
+	int i = 0;
 
 	while (type) {
-		GValue *value = NULL + 1;	
-
-		if (*values) {
-			value = *values++;
-		} else {
-			value = NULL;
-		}
+		CollectEntry entry = _entry(NULL, type);
+		GValue *value = *values ? *values++ : NULL;
 
-		if (!_copy_value(name, type, value, out_value, err, "value %d", i)) return false;
+		if (!_collect_value(name, &entry, i++, value, out_value, err)) return false;
 
 		type = va_arg(args, GType);
 		if (type) out_value = va_arg(args, GValue**);
@@ -879,10 +2229,11 @@ extern bool gsdl_parser_collect_attributes(const gchar *name, gchar* const *attr
 	GValue **out_value = first_value;
 
 	while (type) {
+		CollectEntry entry = _entry(attr_name, type);
 		int i = 0;
 		while (attr_names[i] && strcmp(attr_name, attr_names[i]) != 0) i++;
 
-		if (!_copy_value(name, type, attr_values[i], out_value, err, "attribute \"%s\"", attr_name)) return false;
+		if (!_collect_value(name, &entry, 0, attr_values[i], out_value, err)) return false;
 
 		type = va_arg(args, GType);
 		if (type) {
@@ -894,3 +2245,447 @@ extern bool gsdl_parser_collect_attributes(const gchar *name, gchar* const *attr
 	va_end(args);
 	return true;
 }
+
+/**
+ * gsdl_collect_spec_new:
+ *
+ * Creates an empty #GSDLCollectSpec. Add the values and attributes to be collected with
+ * gsdl_collect_spec_add_value() and gsdl_collect_spec_add_attribute(), then apply it to any number
+ * of tags with gsdl_collect_spec_apply().
+ *
+ * This does the same job as gsdl_parser_collect_values() and gsdl_parser_collect_attributes(), but
+ * does all of the work that does not depend on the tag up front, and finds all of the attributes in
+ * a single pass over the tag's attributes.
+ *
+ * Returns: A new #GSDLCollectSpec, to be freed with gsdl_collect_spec_free().
+ */
+GSDLCollectSpec* gsdl_collect_spec_new() {
+	GSDLCollectSpec *self = g_slice_new(GSDLCollectSpec);
+
+	_source_types_init();
+
+	self->entries = g_array_new(FALSE, FALSE, sizeof(CollectEntry));
+	self->attrs = g_hash_table_new(g_str_hash, g_str_equal);
+
+	return self;
+}
+
+static void _spec_append(GSDLCollectSpec *self, const char *name, GType type) {
+	CollectEntry entry = _entry(name, type);
+
+	entry.cached = true;
+	for (guint i = 0; i < G_N_ELEMENTS(SOURCE_TYPES) && entry.check_type; i++) {
+		if (g_value_type_transformable(SOURCE_TYPES[i], entry.type)) entry.transformable |= 1 << i;
+	}
+
+	g_array_append_val(self->entries, entry);
+}
+
+/**
+ * gsdl_collect_spec_add_value:
+ * @self: A valid #GSDLCollectSpec.
+ * @type: The type that the next value should be converted to, optionally combined with
+ *        %GSDL_GTYPE_OPTIONAL or %GSDL_GTYPE_ANY.
+ *
+ * Adds the tag's next value to the list of things to be collected.
+ */
+void gsdl_collect_spec_add_value(GSDLCollectSpec *self, GType type) {
+	_spec_append(self, NULL, type);
+}
+
+/**
+ * gsdl_collect_spec_add_attribute:
+ * @self: A valid #GSDLCollectSpec.
+ * @name: The attribute's name, which must not have been added already.
+ * @type: The type that the attribute should be converted to, optionally combined with
+ *        %GSDL_GTYPE_OPTIONAL or %GSDL_GTYPE_ANY.
+ *
+ * Adds an attribute to the list of things to be collected.
+ */
+void gsdl_collect_spec_add_attribute(GSDLCollectSpec *self, const gchar *name, GType type) {
+	g_return_if_fail(!g_hash_table_contains(self->attrs, name));
+
+	_spec_append(self, g_strdup(name), type);
+
+	CollectEntry *entry = &g_array_index(self->entries, CollectEntry, self->entries->len - 1);
+	g_hash_table_insert(self->attrs, (gpointer) entry->name, GUINT_TO_POINTER(self->entries->len));
+}
+
+/**
+ * gsdl_collect_spec_free:
+ * @self: A valid #GSDLCollectSpec.
+ */
+void gsdl_collect_spec_free(GSDLCollectSpec *self) {
+	for (guint i = 0; i < self->entries->len; i++) g_free((char*) g_array_index(self->entries, CollectEntry, i).name);
+
+	g_array_free(self->entries, TRUE);
+	g_hash_table_destroy(self->attrs);
+
+	g_slice_free(GSDLCollectSpec, self);
+}
+
+/**
+ * gsdl_collect_spec_apply:
+ * @self: A valid #GSDLCollectSpec.
+ * @tag_name: Name of the tag, for error messages.
+ * @values: The tag's values, as passed to start_tag.
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @out: (out caller-allocates): An array with room for one #GValue pointer for each value and
+ *       attribute that was added to @self, in the order they were added. Each is set to a newly
+ *       allocated #GValue, which should be unset and freed with g_slice_free(), or to %NULL if it was
+ *       optional and missing.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Pulls the values and attributes described by @self out of a tag, converting them to the requested
+ * types. Attributes of the tag that were not added to @self are ignored. If an attribute is given
+ * more than once, the first is used.
+ *
+ * Returns: Whether everything that was not optional was present and of the right type. On failure,
+ *          nothing is left in @out, and @err is set to a %GSDL_SYNTAX_ERROR_MISSING_VALUE or
+ *          %GSDL_SYNTAX_ERROR_BAD_TYPE error.
+ */
+bool gsdl_collect_spec_apply(const GSDLCollectSpec *self, const gchar *tag_name, GValue* const *values, gchar* const *attr_names, GValue* const *attr_values, GValue **out, GError **err) {
+	guint n_entries = self->entries->len;
+	GValue *found[n_entries + 1];
+
+	memset(found, 0, sizeof(found));
+
+	for (guint i = 0; attr_names[i]; i++) {
+		guint index = GPOINTER_TO_UINT(g_hash_table_lookup(self->attrs, attr_names[i]));
+
+		if (index && !found[index - 1]) found[index - 1] = attr_values[i];
+	}
+
+	for (guint i = 0, n_values = 0; i < n_entries; i++) {
+		const CollectEntry *entry = &g_array_index(self->entries, CollectEntry, i);
+		GValue *value = found[i];
+
+		if (!entry->name) value = *values ? *values++ : NULL;
+
+		if (!_collect_value(tag_name, entry, entry->name ? 0 : n_values++, value, &out[i], err)) {
+			for (guint j = 0; j < i; j++) {
+				if (!out[j]) continue;
+
+				g_value_unset(out[j]);
+				g_slice_free(GValue, out[j]);
+				out[j] = NULL;
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//> Typed Accessors
+static const GValue* _attr_find(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, GError **err) {
+	for (guint i = 0; attr_names[i]; i++) {
+		if (strcmp(attr_names[i], name) == 0) return attr_values[i];
+	}
+
+	g_set_error(
+		err,
+		GSDL_SYNTAX_ERROR,
+		GSDL_SYNTAX_ERROR_MISSING_VALUE,
+		"Missing attribute \"%s\"",
+		name
+	);
+
+	return NULL;
+}
+
+static const GValue* _attr_block_find(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, GError **err) {
+	for (guint i = 0; i < n_attrs; i++) {
+		if (strcmp(attr_names[i], name) == 0) return &attr_values[i];
+	}
+
+	g_set_error(
+		err,
+		GSDL_SYNTAX_ERROR,
+		GSDL_SYNTAX_ERROR_MISSING_VALUE,
+		"Missing attribute \"%s\"",
+		name
+	);
+
+	return NULL;
+}
+
+static bool _attr_type_error(const gchar *name, const char *expected, const GValue *value, GError **err) {
+	g_set_error(
+		err,
+		GSDL_SYNTAX_ERROR,
+		GSDL_SYNTAX_ERROR_BAD_TYPE,
+		"Attribute \"%s\" should be %s, got %s",
+		name,
+		expected,
+		G_VALUE_TYPE_NAME(value)
+	);
+
+	return false;
+}
+
+/*
+ * _attr_as_int64, _attr_as_double, _attr_as_string, _attr_as_datetime, _attr_as_bytes:
+ *
+ * Check the type of an attribute that has already been found, and pull out its contents. Shared
+ * between the gsdl_attr_get_*() and gsdl_attr_block_get_*() functions.
+ */
+static bool _attr_as_int64(const gchar *name, const GValue *value, gint64 *out, GError **err) {
+	if (G_VALUE_HOLDS_INT(value)) {
+		*out = g_value_get_int(value);
+	} else if (G_VALUE_HOLDS_INT64(value)) {
+		*out = g_value_get_int64(value);
+	} else {
+		return _attr_type_error(name, "an integer", value, err);
+	}
+
+	return true;
+}
+
+static bool _attr_as_double(const gchar *name, const GValue *value, gdouble *out, GError **err) {
+	if (G_VALUE_HOLDS_DOUBLE(value)) {
+		*out = g_value_get_double(value);
+	} else if (G_VALUE_HOLDS_FLOAT(value)) {
+		*out = g_value_get_float(value);
+	} else if (G_VALUE_HOLDS_INT(value)) {
+		*out = g_value_get_int(value);
+	} else if (G_VALUE_HOLDS_INT64(value)) {
+		*out = g_value_get_int64(value);
+	} else {
+		return _attr_type_error(name, "a number", value, err);
+	}
+
+	return true;
+}
+
+static bool _attr_as_string(const gchar *name, const GValue *value, const gchar **out, GError **err) {
+	if (!G_VALUE_HOLDS_STRING(value)) return _attr_type_error(name, "a string", value, err);
+
+	*out = g_value_get_string(value);
+
+	return true;
+}
+
+static bool _attr_as_datetime(const gchar *name, const GValue *value, const GDateTime **out, GError **err) {
+	if (!GSDL_GVALUE_HOLDS_DATETIME(value)) return _attr_type_error(name, "a date/time", value, err);
+
+	*out = gsdl_gvalue_get_datetime(value);
+
+	return true;
+}
+
+static bool _attr_as_bytes(const gchar *name, const GValue *value, const guint8 **data, gsize *len, GError **err) {
+	if (!GSDL_GVALUE_HOLDS_BINARY(value)) return _attr_type_error(name, "binary data", value, err);
+
+	const GByteArray *bytes = gsdl_gvalue_get_binary(value);
+	*data = bytes->data;
+	*len = bytes->len;
+
+	return true;
+}
+
+/**
+ * gsdl_attr_get_int64:
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @name: Name of the attribute to look up.
+ * @out: (out): Location to store the attribute's value.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Looks up an integer attribute, of either size, without copying it into a new #GValue.
+ *
+ * Returns: Whether the attribute was present and an integer. If not, @out is left alone, and @err
+ *          is set to a %GSDL_SYNTAX_ERROR_MISSING_VALUE or %GSDL_SYNTAX_ERROR_BAD_TYPE error.
+ */
+bool gsdl_attr_get_int64(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, gint64 *out, GError **err) {
+	const GValue *value = _attr_find(attr_names, attr_values, name, err);
+	REQUIRE(value);
+
+	return _attr_as_int64(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_get_double:
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @name: Name of the attribute to look up.
+ * @out: (out): Location to store the attribute's value.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Looks up a number attribute, which may be a float, double or integer.
+ *
+ * Returns: Whether the attribute was present and a number. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_get_double(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, gdouble *out, GError **err) {
+	const GValue *value = _attr_find(attr_names, attr_values, name, err);
+	REQUIRE(value);
+
+	return _attr_as_double(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_get_string:
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @name: Name of the attribute to look up.
+ * @out: (out) (transfer none): Location to store the attribute's value, which stays valid until
+ *       start_tag returns.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Looks up a string attribute, without copying it.
+ *
+ * Returns: Whether the attribute was present and a string. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_get_string(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const gchar **out, GError **err) {
+	const GValue *value = _attr_find(attr_names, attr_values, name, err);
+	REQUIRE(value);
+
+	return _attr_as_string(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_get_datetime:
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @name: Name of the attribute to look up.
+ * @out: (out) (transfer none): Location to store the attribute's value, which stays valid until
+ *       start_tag returns.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Looks up a date/time attribute, without taking a reference to it.
+ *
+ * Returns: Whether the attribute was present and a date/time. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_get_datetime(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const GDateTime **out, GError **err) {
+	const GValue *value = _attr_find(attr_names, attr_values, name, err);
+	REQUIRE(value);
+
+	return _attr_as_datetime(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_get_bytes:
+ * @attr_names: The tag's attribute names, as passed to start_tag.
+ * @attr_values: The tag's attribute values, as passed to start_tag.
+ * @name: Name of the attribute to look up.
+ * @data: (out) (transfer none): Location to store the attribute's data, which stays valid until
+ *        start_tag returns.
+ * @len: (out): Location to store the length of the data.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Looks up a binary attribute, without copying it.
+ *
+ * Returns: Whether the attribute was present and binary. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_get_bytes(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const guint8 **data, gsize *len, GError **err) {
+	const GValue *value = _attr_find(attr_names, attr_values, name, err);
+	REQUIRE(value);
+
+	return _attr_as_bytes(name, value, data, len, err);
+}
+
+/**
+ * gsdl_attr_block_get_int64:
+ * @attr_names: The tag's attribute names, as passed to start_tag_block.
+ * @attr_values: The tag's attribute values, as passed to start_tag_block.
+ * @n_attrs: Number of attributes, as passed to start_tag_block.
+ * @name: Name of the attribute to look up.
+ * @out: (out): Location to store the attribute's value.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Like gsdl_attr_get_int64(), for the contiguous attributes passed to start_tag_block.
+ *
+ * Returns: Whether the attribute was present and an integer. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_block_get_int64(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, gint64 *out, GError **err) {
+	const GValue *value = _attr_block_find(attr_names, attr_values, n_attrs, name, err);
+	REQUIRE(value);
+
+	return _attr_as_int64(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_block_get_double:
+ * @attr_names: The tag's attribute names, as passed to start_tag_block.
+ * @attr_values: The tag's attribute values, as passed to start_tag_block.
+ * @n_attrs: Number of attributes, as passed to start_tag_block.
+ * @name: Name of the attribute to look up.
+ * @out: (out): Location to store the attribute's value.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Like gsdl_attr_get_double(), for the contiguous attributes passed to start_tag_block.
+ *
+ * Returns: Whether the attribute was present and a number. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_block_get_double(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, gdouble *out, GError **err) {
+	const GValue *value = _attr_block_find(attr_names, attr_values, n_attrs, name, err);
+	REQUIRE(value);
+
+	return _attr_as_double(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_block_get_string:
+ * @attr_names: The tag's attribute names, as passed to start_tag_block.
+ * @attr_values: The tag's attribute values, as passed to start_tag_block.
+ * @n_attrs: Number of attributes, as passed to start_tag_block.
+ * @name: Name of the attribute to look up.
+ * @out: (out) (transfer none): Location to store the attribute's value, which stays valid until
+ *       start_tag_block returns.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Like gsdl_attr_get_string(), for the contiguous attributes passed to start_tag_block.
+ *
+ * Returns: Whether the attribute was present and a string. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_block_get_string(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const gchar **out, GError **err) {
+	const GValue *value = _attr_block_find(attr_names, attr_values, n_attrs, name, err);
+	REQUIRE(value);
+
+	return _attr_as_string(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_block_get_datetime:
+ * @attr_names: The tag's attribute names, as passed to start_tag_block.
+ * @attr_values: The tag's attribute values, as passed to start_tag_block.
+ * @n_attrs: Number of attributes, as passed to start_tag_block.
+ * @name: Name of the attribute to look up.
+ * @out: (out) (transfer none): Location to store the attribute's value, which stays valid until
+ *       start_tag_block returns.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Like gsdl_attr_get_datetime(), for the contiguous attributes passed to start_tag_block.
+ *
+ * Returns: Whether the attribute was present and a date/time. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_block_get_datetime(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const GDateTime **out, GError **err) {
+	const GValue *value = _attr_block_find(attr_names, attr_values, n_attrs, name, err);
+	REQUIRE(value);
+
+	return _attr_as_datetime(name, value, out, err);
+}
+
+/**
+ * gsdl_attr_block_get_bytes:
+ * @attr_names: The tag's attribute names, as passed to start_tag_block.
+ * @attr_values: The tag's attribute values, as passed to start_tag_block.
+ * @n_attrs: Number of attributes, as passed to start_tag_block.
+ * @name: Name of the attribute to look up.
+ * @data: (out) (transfer none): Location to store the attribute's data, which stays valid until
+ *        start_tag_block returns.
+ * @len: (out): Location to store the length of the data.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Like gsdl_attr_get_bytes(), for the contiguous attributes passed to start_tag_block.
+ *
+ * Returns: Whether the attribute was present and binary. See gsdl_attr_get_int64().
+ */
+bool gsdl_attr_block_get_bytes(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const guint8 **data, gsize *len, GError **err) {
+	const GValue *value = _attr_block_find(attr_names, attr_values, n_attrs, name, err);
+	REQUIRE(value);
+
+	return _attr_as_bytes(name, value, data, len, err);
+}
@@ -30,6 +30,31 @@
  */
 typedef struct _GSDLParserContext GSDLParserContext;
 
+/**
+ * GSDLCollectSpec:
+ *
+ * A precompiled list of values and attributes to pull out of tags. All fields in GSDLCollectSpec
+ * are private.
+ */
+typedef struct _GSDLCollectSpec GSDLCollectSpec;
+
+/**
+ * GSDLValueRef:
+ * @type: The #GType the value will have once decoded.
+ * @offset: Byte offset of the start of the value in the input; see gsdl_tokenizer_get_location().
+ *
+ * A handle for a value that has been checked for correct syntax, but not decoded yet. Passed to
+ * the %start_tag_lazy callback, and decoded with gsdl_parser_context_decode().
+ */
+typedef struct {
+	GType type;
+	gsize offset;
+
+	/*< private >*/
+	guint _first_token;
+	guint _n_tokens;
+} GSDLValueRef;
+
 /**
  * GSDLParser:
  * @start_tag: Callback to invoke when a new element is entered. This is called for empty tags. 
@@ -37,11 +62,20 @@ typedef struct _GSDLParserContext GSDLParserContext;
  * @end_tag: Callback to invoke at the end of an element.
  * @error: Callback to invoke when an error occurs. The error will be of type %G_CONVERT_ERROR,
  *         %G_IO_CHANNEL_ERROR or %GSDL_SYNTAX_ERROR.
+ * @start_tag_block: Optional replacement for %start_tag, which gets each kind of value as a
+ *                   contiguous array instead of an array of pointers. %attr_names is still
+ *                   %NULL-terminated. If set, %start_tag is not called.
+ * @start_tag_lazy: Optional replacement for %start_tag and %start_tag_block, which gets handles for
+ *                  the values instead of the values themselves. Only the values that are passed to
+ *                  gsdl_parser_context_decode() are fully parsed, so errors in the others (such as
+ *                  out-of-range numbers or unknown timezones) are never noticed. If set, neither
+ *                  %start_tag nor %start_tag_block is called.
  *
  * A set of parsing callbacks.
  *
- * Note: the %start_tag and %end_tag callbacks can optionally set an error, which will cause the
- * %error callback to be called with that error and parsing to immediately stop.
+ * Note: the %start_tag, %start_tag_block, %start_tag_lazy and %end_tag callbacks can optionally set
+ * an error, which will cause the %error callback to be called with that error and parsing to
+ * immediately stop.
  */
 
 typedef struct {
@@ -68,6 +102,30 @@ typedef struct {
 		gpointer user_data
 	);
 
+	void (*start_tag_block)(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GValue *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GValue *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	);
+
+	void (*start_tag_lazy)(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GSDLValueRef *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GSDLValueRef *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	);
+
 } GSDLParser;
 
 #define GSDL_GTYPE_ANY 1L << (sizeof(GType) * 8 - 1)
@@ -75,14 +133,45 @@ typedef struct {
 #define GSDL_GTYPE_OPTIONAL 1L << (sizeof(GType) * 8 - 2)
 
 extern GSDLParserContext* gsdl_parser_context_new(GSDLParser *parser, gpointer user_data);
+extern void gsdl_parser_context_reset(GSDLParserContext *self);
+extern void gsdl_parser_context_free(GSDLParserContext *self);
 
 extern void gsdl_parser_context_push(GSDLParserContext *self, GSDLParser *parser, gpointer user_data);
 extern gpointer gsdl_parser_context_pop(GSDLParserContext *self);
 
+extern void gsdl_parser_context_set_max_depth(GSDLParserContext *self, guint max_depth);
+extern void gsdl_parser_context_skip_children(GSDLParserContext *self);
+
+extern bool gsdl_parser_context_add_projection(GSDLParserContext *self, const char *path, GError **err);
+extern void gsdl_parser_context_clear_projections(GSDLParserContext *self);
+
 extern bool gsdl_parser_context_parse_file(GSDLParserContext *self, const char *filename);
 extern bool gsdl_parser_context_parse_string(GSDLParserContext *self, const char *str);
 
+extern bool gsdl_parser_context_feed(GSDLParserContext *self, const char *buf, gsize len);
+extern bool gsdl_parser_context_end(GSDLParserContext *self);
+
+extern bool gsdl_parser_context_decode(GSDLParserContext *self, const GSDLValueRef *ref, GValue *value, GError **err);
+
 extern bool gsdl_parser_collect_values(const gchar *name, GValue* const *values, GError **err, GType first_type, GValue **first_value, ...);
 extern bool gsdl_parser_collect_attributes(const gchar *name, gchar* const *attr_names, GValue* const *attr_values, GError **err, GType first_type, const gchar *first_name, GValue **first_value, ...);
 
+extern GSDLCollectSpec* gsdl_collect_spec_new();
+extern void gsdl_collect_spec_add_value(GSDLCollectSpec *self, GType type);
+extern void gsdl_collect_spec_add_attribute(GSDLCollectSpec *self, const gchar *name, GType type);
+extern void gsdl_collect_spec_free(GSDLCollectSpec *self);
+extern bool gsdl_collect_spec_apply(const GSDLCollectSpec *self, const gchar *tag_name, GValue* const *values, gchar* const *attr_names, GValue* const *attr_values, GValue **out, GError **err);
+
+extern bool gsdl_attr_get_int64(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, gint64 *out, GError **err);
+extern bool gsdl_attr_get_double(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, gdouble *out, GError **err);
+extern bool gsdl_attr_get_string(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const gchar **out, GError **err);
+extern bool gsdl_attr_get_datetime(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const GDateTime **out, GError **err);
+extern bool gsdl_attr_get_bytes(gchar* const *attr_names, GValue* const *attr_values, const gchar *name, const guint8 **data, gsize *len, GError **err);
+
+extern bool gsdl_attr_block_get_int64(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, gint64 *out, GError **err);
+extern bool gsdl_attr_block_get_double(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, gdouble *out, GError **err);
+extern bool gsdl_attr_block_get_string(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const gchar **out, GError **err);
+extern bool gsdl_attr_block_get_datetime(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const GDateTime **out, GError **err);
+extern bool gsdl_attr_block_get_bytes(gchar* const *attr_names, const GValue *attr_values, guint n_attrs, const gchar *name, const guint8 **data, gsize *len, GError **err);
+
 #endif
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "path.h"
+#include "syntax.h"
+
+extern bool _gsdl_tokenizer_is_identifier_char(gunichar c);
+
+//> Internal Functions
+/*
+ * _identifier_end:
+ * @p: Position in a valid UTF-8 string.
+ *
+ * Returns: The end of the run of identifier characters starting at @p.
+ */
+static const char* _identifier_end(const char *p) {
+	while (*p && _gsdl_tokenizer_is_identifier_char(g_utf8_get_char(p))) p = g_utf8_next_char(p);
+
+	return p;
+}
+
+static void _set_error(GError **err, const char *str, const char *p, const char *expected) {
+	g_set_error(err,
+		GSDL_SYNTAX_ERROR,
+		GSDL_SYNTAX_ERROR_BAD_PATH,
+		"Expected %s at character %ld of path \"%s\"",
+		expected,
+		g_utf8_pointer_to_offset(str, p) + 1,
+		str
+	);
+}
+
+static void _step_clear(GSDLPathStep *step) {
+	for (guint i = 0; i < step->n_preds; i++) {
+		g_free(step->preds[i].attr);
+		g_free(step->preds[i].str);
+	}
+
+	g_free(step->preds);
+	g_free(step->name);
+}
+
+/*
+ * _parse_literal:
+ * @str: The whole path, for error messages.
+ * @p: (inout): Position of the literal; left after it on success.
+ * @pred: Predicate to store the literal in.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Parses a double-quoted string (where only '\"' and '\\' are escapes) or a decimal integer.
+ *
+ * Returns: Whether the literal was valid.
+ */
+static bool _parse_literal(const char *str, const char **p, GSDLPathPredicate *pred, GError **err) {
+	const char *pos = *p;
+
+	if (*pos == '"') {
+		GString *result = g_string_new("");
+
+		for (pos++; *pos != '"'; pos++) {
+			if (!*pos) {
+				_set_error(err, str, pos, "'\"'");
+				g_string_free(result, TRUE);
+				return false;
+			}
+
+			if (*pos == '\\' && (pos[1] == '"' || pos[1] == '\\')) pos++;
+			g_string_append_c(result, *pos);
+		}
+
+		pred->len = result->len;
+		pred->str = g_string_free(result, FALSE);
+		*p = pos + 1;
+	} else {
+		char *end;
+
+		errno = 0;
+		pred->num = g_ascii_strtoll(pos, &end, 10);
+
+		if (!g_ascii_isdigit(*pos == '-' ? pos[1] : *pos) || errno) {
+			_set_error(err, str, pos, "string or integer");
+			return false;
+		}
+
+		*p = end;
+	}
+
+	return true;
+}
+
+/*
+ * _gsdl_path_parse:
+ * @str: A path, made up of tag names or '*'s separated by '/'s, optionally followed by one or
+ *       more '@' and an attribute name. Each tag name can be followed by one or more checks on its
+ *       attributes, as '@', an attribute name, '=' and a string or integer.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Returns: The parsed path, to be freed with _gsdl_path_free(), or %NULL on failure.
+ */
+GSDLPath* _gsdl_path_parse(const char *str, GError **err) {
+	g_return_val_if_fail(g_utf8_validate(str, -1, NULL), NULL);
+
+	GArray *steps = g_array_new(FALSE, FALSE, sizeof(GSDLPathStep));
+	GArray *preds = g_array_new(FALSE, FALSE, sizeof(GSDLPathPredicate));
+	GPtrArray *attrs = g_ptr_array_new();
+	const char *p = str, *end;
+
+	while (true) {
+		GSDLPathStep step = { NULL };
+
+		if (*p == '*') {
+			p++;
+		} else {
+			if ((end = _identifier_end(p)) == p) {
+				_set_error(err, str, p, "tag name or '*'");
+				goto error;
+			}
+
+			step.name = g_strndup(p, end - p);
+			p = end;
+		}
+
+		g_array_append_val(steps, step);
+
+		while (*p == '@') {
+			GSDLPathPredicate pred = { NULL };
+
+			if ((end = _identifier_end(p + 1)) == p + 1) {
+				_set_error(err, str, p + 1, "attribute name");
+				goto error;
+			}
+
+			// Otherwise, this is the start of the attributes to pick out.
+			if (*end != '=') break;
+
+			pred.attr = g_strndup(p + 1, end - p - 1);
+			p = end + 1;
+
+			if (!_parse_literal(str, &p, &pred, err)) {
+				g_free(pred.attr);
+				goto error;
+			}
+
+			g_array_append_val(preds, pred);
+		}
+
+		if (preds->len) {
+			GSDLPathStep *last = &g_array_index(steps, GSDLPathStep, steps->len - 1);
+
+			last->n_preds = preds->len;
+			last->preds = g_memdup(preds->data, preds->len * sizeof(GSDLPathPredicate));
+			g_array_set_size(preds, 0);
+		}
+
+		if (*p != '/') break;
+		p++;
+	}
+
+	while (*p == '@') {
+		p++;
+
+		if ((end = _identifier_end(p)) == p) {
+			_set_error(err, str, p, "attribute name");
+			goto error;
+		}
+
+		g_ptr_array_add(attrs, g_strndup(p, end - p));
+		p = end;
+	}
+
+	if (*p) {
+		_set_error(err, str, p, "'/' or '@'");
+		goto error;
+	}
+
+	g_array_free(preds, TRUE);
+
+	GSDLPath *self = g_slice_new(GSDLPath);
+	self->n_steps = steps->len;
+	self->steps = (GSDLPathStep*) g_array_free(steps, FALSE);
+
+	if (attrs->len) {
+		g_ptr_array_add(attrs, NULL);
+		self->attrs = (char**) g_ptr_array_free(attrs, FALSE);
+	} else {
+		self->attrs = NULL;
+		g_ptr_array_free(attrs, TRUE);
+	}
+
+	return self;
+
+	error:
+	for (guint i = 0; i < steps->len; i++) _step_clear(&g_array_index(steps, GSDLPathStep, i));
+	g_array_free(steps, TRUE);
+
+	for (guint i = 0; i < preds->len; i++) {
+		g_free(g_array_index(preds, GSDLPathPredicate, i).attr);
+		g_free(g_array_index(preds, GSDLPathPredicate, i).str);
+	}
+	g_array_free(preds, TRUE);
+
+	g_ptr_array_set_free_func(attrs, g_free);
+	g_ptr_array_free(attrs, TRUE);
+
+	return NULL;
+}
+
+void _gsdl_path_free(GSDLPath *self) {
+	for (guint i = 0; i < self->n_steps; i++) _step_clear(&self->steps[i]);
+	g_free(self->steps);
+	g_strfreev(self->attrs);
+
+	g_slice_free(GSDLPath, self);
+}
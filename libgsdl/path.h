@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// NOTE: This is an internal header, and is not installed.
+
+#ifndef __PATH_H__
+#define __PATH_H__
+
+#include <glib.h>
+
+//> Types
+/*
+ * GSDLPathPredicate:
+ * @attr: Name of the attribute to check.
+ * @str: String the attribute must be equal to, or %NULL if it must be equal to @num instead.
+ * @len: Length of @str.
+ * @num: Integer the attribute must be equal to.
+ *
+ * A check on the value of an attribute, like '@name="a"' or '@port=80'.
+ */
+typedef struct {
+	char *attr;
+	char *str;
+	gsize len;
+	gint64 num;
+} GSDLPathPredicate;
+
+/*
+ * GSDLPathStep:
+ * @name: Name of the tag to match, or %NULL to match any tag ('*').
+ * @preds: Checks on the tag's attributes, all of which must pass.
+ * @n_preds: Number of @preds.
+ */
+typedef struct {
+	char *name;
+	GSDLPathPredicate *preds;
+	guint n_preds;
+} GSDLPathStep;
+
+/*
+ * GSDLPath:
+ * @steps: The tags to match, from the top level down.
+ * @n_steps: Number of steps; always at least one.
+ * @attrs: %NULL-terminated names of the attributes picked out of the last tag ('@name'), or %NULL
+ *         if none were given.
+ *
+ * A parsed path, like "cluster/&ast;/node@name@port" or "cluster/node@name=\"a\"/listener@port".
+ */
+typedef struct {
+	GSDLPathStep *steps;
+	guint n_steps;
+	char **attrs;
+} GSDLPath;
+
+//> Internal Functions
+extern GSDLPath* _gsdl_path_parse(const char *str, GError **err);
+extern void _gsdl_path_free(GSDLPath *self);
+
+#endif
@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:gsdl-query
+ * @short_description: Compiled path queries over a #GSDLDocument.
+ *
+ * A #GSDLQuery finds the tags in a #GSDLDocument that match a path, like
+ * "cluster/node@name=\"a\"/listener@port". Paths are made up of tag names (or '*', which matches
+ * any tag) separated by '/', starting at the top level. Each tag name can be followed by checks on
+ * the tag's attributes, each written as '@', the attribute's name, '=' and a double-quoted string
+ * or an integer. The path can end with one or more '@' and attribute name, to pick out just those
+ * attributes of each matching tag.
+ *
+ * When the last tag in the path has a name or a check, its candidates are looked up in an index of
+ * the document, and only their ancestors are checked; otherwise, the whole tree is walked from the
+ * top level. These indices are built the first time they are needed, then kept until the document
+ * is freed, so repeated queries against the same document only pay for the lookups.
+ */
+
+#include <glib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "document.h"
+#include "path.h"
+#include "query.h"
+
+//> Macros
+// Every thread is given at least this many nodes or candidates to check.
+#define MIN_NODES_PER_THREAD 1024
+
+//> Internal Types
+struct _GSDLQuery {
+	GSDLPath *path;
+
+	// The values checked by each step's predicates, in order.
+	GSDLDocValue *pred_values;
+	guint n_preds;
+};
+
+typedef struct {
+	guint32 attr;
+	const GSDLDocValue *value;
+} ResolvedPred;
+
+/*
+ * ResolvedStep:
+ * @name: Name id of the tag to match, or 0 to match any tag.
+ * @preds: Checks on the tag's attributes, by name id.
+ * @n_preds: Number of @preds.
+ */
+typedef struct {
+	guint32 name;
+	ResolvedPred *preds;
+	guint n_preds;
+} ResolvedStep;
+
+/*
+ * Exec:
+ *
+ * A query, with its names looked up in a particular document.
+ */
+typedef struct {
+	const GSDLDocument *document;
+	const GSDLQuery *query;
+	const guint32 *parents;
+
+	ResolvedStep *steps;
+	guint n_steps;
+	ResolvedPred *preds;
+
+	guint32 *attrs;
+	guint n_attrs;
+} Exec;
+
+/*
+ * Task:
+ *
+ * Part of the work of running a query: either a range of top-level tags to walk down from (ending
+ * before @stop, or at the end if it is 0), or a slice of candidates to check.
+ */
+typedef struct {
+	const Exec *exec;
+
+	guint first;
+	guint stop;
+
+	const guint32 *candidates;
+	guint n_candidates;
+
+	GArray *matches;
+} Task;
+
+extern const guint32* _gsdl_document_get_structure(const GSDLDocument *self, const guint32 **name_starts, const guint32 **named_nodes);
+extern const guint32* _gsdl_document_find_attr_nodes(const GSDLDocument *self, guint32 name_id, const GSDLDocValue *value, guint *n_nodes);
+extern guint _gsdl_document_get_attrs(const GSDLDocument *self, guint node, const guint32 **names, const GSDLDocValue **values);
+extern bool _gsdl_doc_value_equal(const GSDLDocValue *a, const GSDLDocValue *b);
+
+//> Matching
+static bool _step_matches(const Exec *self, const ResolvedStep *step, guint node) {
+	if (step->name && gsdl_document_get_name_id(self->document, node) != step->name) return false;
+	if (!step->n_preds) return true;
+
+	const guint32 *names;
+	const GSDLDocValue *values;
+	guint n_attrs = _gsdl_document_get_attrs(self->document, node, &names, &values);
+
+	for (guint i = 0; i < step->n_preds; i++) {
+		bool found = false;
+
+		for (guint j = 0; j < n_attrs && !found; j++) {
+			found = names[j] == step->preds[i].attr && _gsdl_doc_value_equal(&values[j], step->preds[i].value);
+		}
+
+		if (!found) return false;
+	}
+
+	return true;
+}
+
+static void _emit(const Exec *self, guint node, GArray *matches) {
+	if (!self->query->path->attrs) {
+		GSDLQueryMatch match = { node, NULL, NULL };
+		g_array_append_val(matches, match);
+
+		return;
+	}
+
+	const guint32 *names;
+	const GSDLDocValue *values;
+	guint n_attrs = _gsdl_document_get_attrs(self->document, node, &names, &values);
+
+	for (guint i = 0; i < self->n_attrs; i++) {
+		for (guint j = 0; j < n_attrs; j++) {
+			if (names[j] != self->attrs[i]) continue;
+
+			GSDLQueryMatch match = { node, gsdl_document_name_from_id(self->document, names[j]), &values[j] };
+			g_array_append_val(matches, match);
+			break;
+		}
+	}
+}
+
+/*
+ * _walk:
+ * @self: A resolved query.
+ * @first: First of a run of siblings to check against @step.
+ * @stop: Sibling to stop before, or 0 to check all of them.
+ * @step: Index of the step to match.
+ * @matches: Array to add matches to.
+ *
+ * Matches the remainder of the path top-down.
+ */
+static void _walk(const Exec *self, guint first, guint stop, guint step, GArray *matches) {
+	const GSDLDocument *document = self->document;
+
+	for (guint node = first; node != stop; node = gsdl_document_get_next_sibling(document, node)) {
+		if (!_step_matches(self, &self->steps[step], node)) continue;
+
+		if (step == self->n_steps - 1) {
+			_emit(self, node, matches);
+		} else {
+			_walk(self, gsdl_document_get_first_child(document, node), 0, step + 1, matches);
+		}
+	}
+}
+
+/*
+ * _check_candidate:
+ * @self: A resolved query.
+ * @node: A node that might match the last step.
+ *
+ * Matches the path bottom-up from @node.
+ *
+ * Returns: Whether @node matches the whole path.
+ */
+static bool _check_candidate(const Exec *self, guint node) {
+	if (!_step_matches(self, &self->steps[self->n_steps - 1], node)) return false;
+
+	for (guint i = self->n_steps - 1; i-- > 0; ) {
+		node = self->parents[node];
+		if (!node || !_step_matches(self, &self->steps[i], node)) return false;
+	}
+
+	return self->parents[node] == 0;
+}
+
+static gpointer _run_task(gpointer data) {
+	Task *task = (Task*) data;
+
+	if (task->candidates) {
+		for (guint i = 0; i < task->n_candidates; i++) {
+			if (_check_candidate(task->exec, task->candidates[i])) _emit(task->exec, task->candidates[i], task->matches);
+		}
+	} else {
+		_walk(task->exec, task->first, task->stop, 0, task->matches);
+	}
+
+	return NULL;
+}
+
+//> Execution
+/*
+ * _resolve:
+ * @self: An %Exec with its document and query set.
+ *
+ * Looks up all of the names in the query in the document.
+ *
+ * Returns: Whether the query could match anything; if not, some tag or checked attribute name does
+ *          not appear in the document.
+ */
+static bool _resolve(Exec *self) {
+	const GSDLPath *path = self->query->path;
+	const GSDLDocument *document = self->document;
+	guint pred = 0;
+
+	self->n_steps = path->n_steps;
+	self->steps = g_new(ResolvedStep, path->n_steps);
+	self->preds = g_new(ResolvedPred, self->query->n_preds);
+	self->n_attrs = path->attrs ? g_strv_length(path->attrs) : 0;
+	self->attrs = g_new(guint32, self->n_attrs);
+
+	for (guint i = 0; i < self->n_attrs; i++) self->attrs[i] = gsdl_document_lookup_name(document, path->attrs[i]);
+
+	for (guint i = 0; i < path->n_steps; i++) {
+		const GSDLPathStep *step = &path->steps[i];
+		ResolvedStep *resolved = &self->steps[i];
+
+		resolved->name = step->name ? gsdl_document_lookup_name(document, step->name) : 0;
+		resolved->preds = self->preds + pred;
+		resolved->n_preds = step->n_preds;
+		if (step->name && !resolved->name) return false;
+
+		for (guint j = 0; j < step->n_preds; j++, pred++) {
+			self->preds[pred].attr = gsdl_document_lookup_name(document, step->preds[j].attr);
+			self->preds[pred].value = &self->query->pred_values[pred];
+			if (!self->preds[pred].attr) return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * _find_candidates:
+ * @self: A resolved query.
+ * @n_candidates: (out): Location to store the number of candidates.
+ *
+ * Picks the shortest of the lists of nodes with the last step's name or with one of its checked
+ * attributes. Stops as soon as one of the lists is empty, as then nothing can match.
+ *
+ * Returns: (transfer none): The candidates, or %NULL if the last step has neither a name nor checks
+ *          or if there are no candidates.
+ */
+static const guint32* _find_candidates(const Exec *self, guint *n_candidates) {
+	const ResolvedStep *last = &self->steps[self->n_steps - 1];
+	const guint32 *result = NULL;
+
+	if (last->name) {
+		const guint32 *name_starts, *named_nodes;
+		_gsdl_document_get_structure(self->document, &name_starts, &named_nodes);
+
+		result = named_nodes + name_starts[last->name];
+		*n_candidates = name_starts[last->name + 1] - name_starts[last->name];
+		if (!*n_candidates) return NULL;
+	}
+
+	for (guint i = 0; i < last->n_preds; i++) {
+		guint n_nodes;
+		const guint32 *nodes = _gsdl_document_find_attr_nodes(self->document, last->preds[i].attr, last->preds[i].value, &n_nodes);
+
+		if (!n_nodes) {
+			*n_candidates = 0;
+			return NULL;
+		} else if (!result || n_nodes < *n_candidates) {
+			result = nodes;
+			*n_candidates = n_nodes;
+		}
+	}
+
+	return result;
+}
+
+static guint _split_top_level(const Exec *self, Task *tasks, guint n_tasks) {
+	const GSDLDocument *document = self->document;
+	guint n_nodes = gsdl_document_get_n_nodes(document), used = 0;
+
+	tasks[0].first = gsdl_document_get_first_child(document, 0);
+
+	// Give each task a run of top-level tags covering about the same number of nodes.
+	for (guint node = tasks[0].first; node; node = gsdl_document_get_next_sibling(document, node)) {
+		if (used + 1 < n_tasks && node >= (gsize) (used + 1) * n_nodes / n_tasks) {
+			tasks[used++].stop = node;
+			tasks[used].first = node;
+		}
+	}
+
+	tasks[used++].stop = 0;
+
+	return used;
+}
+
+//> Public Functions
+/**
+ * gsdl_query_compile:
+ * @path: A path, as described above.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Parses a path into a query that can be run against any number of documents.
+ *
+ * Returns: A new #GSDLQuery, to be freed with gsdl_query_free(), or %NULL if @path was not valid.
+ *          If so, the error will be %GSDL_SYNTAX_ERROR_BAD_PATH.
+ */
+GSDLQuery* gsdl_query_compile(const char *path, GError **err) {
+	GSDLPath *parsed = _gsdl_path_parse(path, err);
+	if (!parsed) return NULL;
+
+	GSDLQuery *self = g_slice_new(GSDLQuery);
+	self->path = parsed;
+	self->n_preds = 0;
+
+	for (guint i = 0; i < parsed->n_steps; i++) self->n_preds += parsed->steps[i].n_preds;
+	self->pred_values = g_new0(GSDLDocValue, self->n_preds);
+
+	GSDLDocValue *value = self->pred_values;
+	for (guint i = 0; i < parsed->n_steps; i++) {
+		for (guint j = 0; j < parsed->steps[i].n_preds; j++, value++) {
+			const GSDLPathPredicate *pred = &parsed->steps[i].preds[j];
+
+			if (pred->str) {
+				value->type = GSDL_DOC_STRING;
+				value->len = pred->len;
+				value->v_str = pred->str;
+			} else {
+				value->type = GSDL_DOC_INT64;
+				value->v_int = pred->num;
+			}
+		}
+	}
+
+	return self;
+}
+
+/**
+ * gsdl_query_free:
+ * @self: A valid #GSDLQuery.
+ */
+void gsdl_query_free(GSDLQuery *self) {
+	_gsdl_path_free(self->path);
+	g_free(self->pred_values);
+
+	g_slice_free(GSDLQuery, self);
+}
+
+/**
+ * gsdl_query_exec:
+ * @self: A valid #GSDLQuery.
+ * @document: The document to search.
+ * @n_threads: The most threads to use, including the calling thread. Small documents are always
+ *             searched in the calling thread alone.
+ * @n_matches: (out): Location to store the number of matches.
+ *
+ * Finds the tags in @document matching @self. If the query picks out attributes, there is one match
+ * for each of those attributes that a matching tag has, in the order they were given in the path;
+ * otherwise, there is one for each matching tag.
+ *
+ * Any number of queries can be run against the same document at once.
+ *
+ * Returns: (transfer full) (array length=n_matches): The matches, in document order, to be freed
+ *          with g_free(). May be %NULL if there were none.
+ */
+GSDLQueryMatch* gsdl_query_exec(const GSDLQuery *self, const GSDLDocument *document, guint n_threads, guint *n_matches) {
+	GArray *result = g_array_new(FALSE, FALSE, sizeof(GSDLQueryMatch));
+	Exec exec = { document, self };
+
+	if (!_resolve(&exec)) goto done;
+
+	exec.parents = _gsdl_document_get_structure(document, NULL, NULL);
+
+	guint n_candidates, n_tasks;
+	const guint32 *candidates = _find_candidates(&exec, &n_candidates);
+
+	n_tasks = CLAMP((candidates ? n_candidates : gsdl_document_get_n_nodes(document)) / MIN_NODES_PER_THREAD, 1, MAX(n_threads, 1));
+
+	Task *tasks = g_new0(Task, n_tasks);
+
+	if (candidates) {
+		for (guint i = 0; i < n_tasks; i++) {
+			guint start = (gsize) i * n_candidates / n_tasks, end = (gsize) (i + 1) * n_candidates / n_tasks;
+
+			tasks[i].candidates = candidates + start;
+			tasks[i].n_candidates = end - start;
+		}
+	} else if (!self->path->steps[self->path->n_steps - 1].name && !self->path->steps[self->path->n_steps - 1].n_preds) {
+		n_tasks = _split_top_level(&exec, tasks, n_tasks);
+	} else {
+		// Nothing has the last step's name or checked attribute.
+		n_tasks = 0;
+	}
+
+	GThread **threads = g_new(GThread*, n_tasks);
+
+	for (guint i = 0; i < n_tasks; i++) {
+		tasks[i].exec = &exec;
+		tasks[i].matches = i ? g_array_new(FALSE, FALSE, sizeof(GSDLQueryMatch)) : result;
+		if (i) threads[i] = g_thread_new("gsdl-query", _run_task, &tasks[i]);
+	}
+
+	if (n_tasks) _run_task(&tasks[0]);
+
+	for (guint i = 1; i < n_tasks; i++) {
+		g_thread_join(threads[i]);
+		g_array_append_vals(result, tasks[i].matches->data, tasks[i].matches->len);
+		g_array_free(tasks[i].matches, TRUE);
+	}
+
+	g_free(threads);
+	g_free(tasks);
+
+	done:
+	g_free(exec.steps);
+	g_free(exec.preds);
+	g_free(exec.attrs);
+
+	*n_matches = result->len;
+
+	return (GSDLQueryMatch*) g_array_free(result, FALSE);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __QUERY_H__
+#define __QUERY_H__
+
+#include <glib.h>
+#include <stdbool.h>
+
+#include "document.h"
+
+/**
+ * GSDLQuery:
+ *
+ * All fields in GSDLQuery are private.
+ */
+typedef struct _GSDLQuery GSDLQuery;
+
+/**
+ * GSDLQueryMatch:
+ * @node: Index of the matching tag in the document.
+ * @attr_name: Name of the picked-out attribute, or %NULL if the query did not pick out attributes.
+ * @value: (allow-none): Value of the picked-out attribute, or %NULL.
+ *
+ * One result of gsdl_query_exec(). @attr_name and @value are owned by the document.
+ */
+typedef struct {
+	guint node;
+	const gchar *attr_name;
+	const GSDLDocValue *value;
+} GSDLQueryMatch;
+
+extern GSDLQuery* gsdl_query_compile(const char *path, GError **err);
+extern void gsdl_query_free(GSDLQuery *self);
+
+extern GSDLQueryMatch* gsdl_query_exec(const GSDLQuery *self, const GSDLDocument *document, guint n_threads, guint *n_matches);
+
+#endif
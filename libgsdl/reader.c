@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:gsdl-reader
+ * @short_description: Pull parser for SDL data.
+ *
+ * A #GSDLReader parses a document one event at a time, as the caller asks for them with
+ * gsdl_reader_next(), instead of calling back into the caller. This lets the caller keep its state
+ * in ordinary local variables and control flow, and stop reading at any point just by freeing the
+ * reader.
+ *
+ * Events borrow everything they point to from the reader. Values are handed out as lazy handles
+ * (as with %start_tag_lazy), and only parsed into #GValues by gsdl_reader_decode(); events whose
+ * values are not decoded cost no allocations beyond those of the parser itself.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdbool.h>
+
+#include "parser.h"
+#include "reader.h"
+
+//> Internal Types
+struct _GSDLReader {
+	GSDLParserContext *context;
+
+	// Filled in by the callbacks as the parse is pulled along.
+	GSDLReaderEvent event;
+	GError *error;
+	bool done;
+
+	// The name of the tag that just ended, which the parser throws away along with the tag.
+	GString *end_name;
+};
+
+extern bool _gsdl_parser_context_open_file(GSDLParserContext *self, const char *filename, GError **err);
+extern bool _gsdl_parser_context_open_string(GSDLParserContext *self, const char *str, GError **err);
+extern void _gsdl_parser_context_pause(GSDLParserContext *self);
+extern bool _gsdl_parser_context_pull(GSDLParserContext *self, bool *done);
+
+//> Callbacks
+static void _start_tag_lazy(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GSDLValueRef *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GSDLValueRef *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GSDLReader *self = (GSDLReader*) user_data;
+
+	self->event = (GSDLReaderEvent) {
+		GSDL_READER_START,
+		name,
+		values,
+		n_values,
+		attr_names,
+		attr_values,
+		n_attrs,
+	};
+
+	_gsdl_parser_context_pause(context);
+}
+
+static void _end_tag(GSDLParserContext *context, const gchar *name, gpointer user_data, GError **err) {
+	GSDLReader *self = (GSDLReader*) user_data;
+
+	g_string_assign(self->end_name, name);
+	self->event = (GSDLReaderEvent) { GSDL_READER_END, self->end_name->str };
+
+	_gsdl_parser_context_pause(context);
+}
+
+static void _error(GSDLParserContext *context, GError *err, gpointer user_data) {
+	GSDLReader *self = (GSDLReader*) user_data;
+
+	if (self->error) {
+		g_error_free(err);
+	} else {
+		self->error = err;
+	}
+}
+
+static GSDLParser READER_PARSER = {
+	NULL,
+	_end_tag,
+	_error,
+	NULL,
+	_start_tag_lazy,
+};
+
+static GSDLReader* _reader_new() {
+	GSDLReader *self = g_slice_new0(GSDLReader);
+
+	self->context = gsdl_parser_context_new(&READER_PARSER, self);
+	self->end_name = g_string_new("");
+
+	return self;
+}
+
+//> Public Functions
+/**
+ * gsdl_reader_new_from_file:
+ * @filename: Path to an SDL file to read.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Returns: A new #GSDLReader, to be freed with gsdl_reader_free(), or %NULL if the file could not
+ *          be opened.
+ */
+GSDLReader* gsdl_reader_new_from_file(const char *filename, GError **err) {
+	GSDLReader *self = _reader_new();
+
+	if (!_gsdl_parser_context_open_file(self->context, filename, err)) {
+		gsdl_reader_free(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+/**
+ * gsdl_reader_new_from_string:
+ * @str: A UTF-8 encoded string to read. It is not copied, and must stay valid until the reader is
+ *       freed.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Returns: A new #GSDLReader, to be freed with gsdl_reader_free(), or %NULL if @str was not valid
+ *          UTF-8.
+ */
+GSDLReader* gsdl_reader_new_from_string(const char *str, GError **err) {
+	GSDLReader *self = _reader_new();
+
+	if (!_gsdl_parser_context_open_string(self->context, str, err)) {
+		gsdl_reader_free(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+/**
+ * gsdl_reader_free:
+ * @self: A valid #GSDLReader.
+ *
+ * Frees @self. This may be done at any point, without reading the rest of the document.
+ */
+void gsdl_reader_free(GSDLReader *self) {
+	gsdl_parser_context_reset(self->context);
+	gsdl_parser_context_free(self->context);
+
+	g_clear_error(&self->error);
+	g_string_free(self->end_name, TRUE);
+
+	g_slice_free(GSDLReader, self);
+}
+
+/**
+ * gsdl_reader_set_max_depth:
+ * @self: A valid #GSDLReader.
+ * @max_depth: The maximum number of tags that may be open at once, or 0 for no limit.
+ *
+ * See gsdl_parser_context_set_max_depth().
+ */
+void gsdl_reader_set_max_depth(GSDLReader *self, guint max_depth) {
+	gsdl_parser_context_set_max_depth(self->context, max_depth);
+}
+
+/**
+ * gsdl_reader_next:
+ * @self: A valid #GSDLReader.
+ * @event: (out caller-allocates): Location to store the next event.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Reads just far enough to find the next event. Every %GSDL_READER_START is matched by a
+ * %GSDL_READER_END, and the last event is always %GSDL_READER_EOF, which is returned again by any
+ * further calls.
+ *
+ * Returns: Whether the next event could be read. Once this fails, further calls return
+ *          %GSDL_READER_EOF.
+ */
+bool gsdl_reader_next(GSDLReader *self, GSDLReaderEvent *event, GError **err) {
+	self->event = (GSDLReaderEvent) { GSDL_READER_EOF };
+
+	if (!self->done) {
+		bool success = _gsdl_parser_context_pull(self->context, &self->done);
+
+		if (!success) {
+			g_propagate_error(err, self->error);
+			self->error = NULL;
+
+			return false;
+		}
+	}
+
+	*event = self->event;
+
+	return true;
+}
+
+/**
+ * gsdl_reader_decode:
+ * @self: A valid #GSDLReader.
+ * @ref: One of the value handles from the last %GSDL_READER_START event.
+ * @value: A zero-filled #GValue to store the value in. It must be unset by the caller.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Fully parses one of the current tag's values or attributes. See gsdl_parser_context_decode().
+ *
+ * Returns: Whether the value could be decoded.
+ */
+bool gsdl_reader_decode(GSDLReader *self, const GSDLValueRef *ref, GValue *value, GError **err) {
+	return gsdl_parser_context_decode(self->context, ref, value, err);
+}
+
+/**
+ * gsdl_reader_skip_children:
+ * @self: A valid #GSDLReader.
+ *
+ * May be called right after a %GSDL_READER_START event to skip the tag's children, so the next
+ * event is its %GSDL_READER_END. As with gsdl_parser_context_skip_children(), they are not
+ * tokenized, and errors inside them (other than a missing '}') are not reported.
+ */
+void gsdl_reader_skip_children(GSDLReader *self) {
+	gsdl_parser_context_skip_children(self->context);
+}
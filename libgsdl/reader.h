@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __READER_H__
+#define __READER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdbool.h>
+
+#include "parser.h"
+
+/**
+ * GSDLReader:
+ *
+ * All fields in GSDLReader are private.
+ */
+typedef struct _GSDLReader GSDLReader;
+
+/**
+ * GSDLReaderEventType:
+ * @GSDL_READER_START: A tag was started.
+ * @GSDL_READER_END: A tag was ended, after all of its children.
+ * @GSDL_READER_EOF: The end of the document was reached.
+ *
+ * The kinds of event returned by gsdl_reader_next().
+ */
+typedef enum {
+	GSDL_READER_START,
+	GSDL_READER_END,
+	GSDL_READER_EOF,
+} GSDLReaderEventType;
+
+/**
+ * GSDLReaderEvent:
+ * @type: The kind of event.
+ * @name: Name of the tag, for %GSDL_READER_START and %GSDL_READER_END.
+ * @values: Handles for the tag's values, for %GSDL_READER_START; see gsdl_reader_decode().
+ * @n_values: Number of @values.
+ * @attr_names: %NULL-terminated names of the tag's attributes, for %GSDL_READER_START.
+ * @attr_values: Handles for the tag's attributes, for %GSDL_READER_START.
+ * @n_attrs: Number of @attr_values.
+ *
+ * A single event from a #GSDLReader. Everything it points to is owned by the reader, and only valid
+ * until the next call to gsdl_reader_next().
+ */
+typedef struct {
+	GSDLReaderEventType type;
+	const gchar *name;
+
+	const GSDLValueRef *values;
+	guint n_values;
+
+	gchar* const *attr_names;
+	const GSDLValueRef *attr_values;
+	guint n_attrs;
+} GSDLReaderEvent;
+
+extern GSDLReader* gsdl_reader_new_from_file(const char *filename, GError **err);
+extern GSDLReader* gsdl_reader_new_from_string(const char *str, GError **err);
+extern void gsdl_reader_free(GSDLReader *self);
+
+extern void gsdl_reader_set_max_depth(GSDLReader *self, guint max_depth);
+
+extern bool gsdl_reader_next(GSDLReader *self, GSDLReaderEvent *event, GError **err);
+extern bool gsdl_reader_decode(GSDLReader *self, const GSDLValueRef *ref, GValue *value, GError **err);
+extern void gsdl_reader_skip_children(GSDLReader *self);
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:gsdl-stream
+ * @short_description: Queries evaluated while parsing, without building a document.
+ *
+ * A #GSDLStreamQuery finds the tags matching a path as they are parsed, and passes only those to a
+ * set of callbacks. Paths are written as for gsdl_query_compile(), like "log/event@level=\"error\"".
+ *
+ * Tag names are matched with projections (see gsdl_parser_context_add_projection()), so any tag
+ * that cannot lead to a match is skipped without being tokenized, and only the attributes that are
+ * checked or picked out are decoded. The attribute checks are made as each tag on the path is
+ * started; if they fail, its children are skipped as well. Nothing is kept about a tag once it has
+ * been started, so memory use is bounded by the nesting depth (as with the parser) rather than by
+ * the size of the document.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "parser.h"
+#include "path.h"
+#include "stream.h"
+
+//> Internal Types
+struct _GSDLStreamQuery {
+	GSDLPath *path;
+	GSDLParserContext *context;
+
+	GSDLParser *parser;
+	gpointer user_data;
+
+	// Scratch space for the decoded values and attributes of the tag being started, and the
+	// attributes picked out of it.
+	GArray *values;
+	GArray *attr_values;
+	GArray *picked_values;
+	GPtrArray *picked_names;
+};
+
+extern guint _gsdl_parser_context_get_depth(const GSDLParserContext *self);
+
+//> Matching
+static bool _value_matches(const GValue *value, const GSDLPathPredicate *pred) {
+	if (pred->str) return G_VALUE_HOLDS_STRING(value) && strcmp(g_value_get_string(value), pred->str) == 0;
+	if (G_VALUE_HOLDS_INT(value)) return g_value_get_int(value) == pred->num;
+	if (G_VALUE_HOLDS_INT64(value)) return g_value_get_int64(value) == pred->num;
+
+	return false;
+}
+
+static bool _preds_match(const GSDLPathStep *step, gchar* const *attr_names, const GValue *attr_values, guint n_attrs) {
+	for (guint i = 0; i < step->n_preds; i++) {
+		bool found = false;
+
+		for (guint j = 0; j < n_attrs && !found; j++) {
+			found = strcmp(attr_names[j], step->preds[i].attr) == 0 && _value_matches(&attr_values[j], &step->preds[i]);
+		}
+
+		if (!found) return false;
+	}
+
+	return true;
+}
+
+static bool _decode_all(GSDLParserContext *context, const GSDLValueRef *refs, guint n_refs, GArray *out, GError **err) {
+	g_array_set_size(out, n_refs);
+
+	for (guint i = 0; i < n_refs; i++) {
+		if (!gsdl_parser_context_decode(context, &refs[i], &g_array_index(out, GValue, i), err)) return false;
+	}
+
+	return true;
+}
+
+static void _clear_values(GArray *values) {
+	for (guint i = 0; i < values->len; i++) {
+		GValue *value = &g_array_index(values, GValue, i);
+		if (G_IS_VALUE(value)) g_value_unset(value);
+	}
+
+	g_array_set_size(values, 0);
+}
+
+static bool _picked(const GSDLStreamQuery *self, const gchar *name) {
+	for (char **attr = self->path->attrs; *attr; attr++) {
+		if (strcmp(*attr, name) == 0) return true;
+	}
+
+	return false;
+}
+
+static void _emit(GSDLStreamQuery *self, GSDLParserContext *context, const gchar *name, gchar* const *attr_names, GError **err) {
+	const GValue *attr_values = (GValue*) self->attr_values->data;
+	guint n_attrs = self->attr_values->len;
+
+	// The projection also passes through the attributes that were only checked.
+	if (self->path->attrs) {
+		for (guint i = 0; i < n_attrs; i++) {
+			if (!_picked(self, attr_names[i])) continue;
+
+			g_ptr_array_add(self->picked_names, attr_names[i]);
+			g_array_append_vals(self->picked_values, &attr_values[i], 1);
+		}
+
+		n_attrs = self->picked_values->len;
+		g_ptr_array_add(self->picked_names, NULL);
+		attr_names = (gchar**) self->picked_names->pdata;
+		attr_values = (GValue*) self->picked_values->data;
+	}
+
+	self->parser->start_tag_block(
+		context,
+		name,
+		(GValue*) self->values->data,
+		self->values->len,
+		attr_names,
+		attr_values,
+		n_attrs,
+		self->user_data,
+		err
+	);
+
+	// These only hold borrowed copies of the attributes.
+	g_ptr_array_set_size(self->picked_names, 0);
+	g_array_set_size(self->picked_values, 0);
+}
+
+static void _start_tag_lazy(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GSDLValueRef *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GSDLValueRef *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GSDLStreamQuery *self = (GSDLStreamQuery*) user_data;
+	guint depth = _gsdl_parser_context_get_depth(context);
+	const GSDLPathStep *step = &self->path->steps[depth];
+
+	// The projections only let through the last step and those with checks, and only the
+	// attributes they need.
+	if (!_decode_all(context, attr_values, n_attrs, self->attr_values, err)) goto done;
+
+	if (!_preds_match(step, attr_names, (GValue*) self->attr_values->data, n_attrs)) {
+		gsdl_parser_context_skip_children(context);
+		goto done;
+	}
+
+	if (depth == self->path->n_steps - 1) {
+		// Nothing inside a match can match.
+		gsdl_parser_context_skip_children(context);
+
+		if (_decode_all(context, values, n_values, self->values, err)) _emit(self, context, name, attr_names, err);
+	}
+
+	done:
+	_clear_values(self->values);
+	_clear_values(self->attr_values);
+}
+
+static void _error(GSDLParserContext *context, GError *err, gpointer user_data) {
+	GSDLStreamQuery *self = (GSDLStreamQuery*) user_data;
+
+	if (self->parser->error) {
+		self->parser->error(context, err, self->user_data);
+	} else {
+		g_error_free(err);
+	}
+}
+
+static GSDLParser STREAM_PARSER = {
+	NULL,
+	NULL,
+	_error,
+	NULL,
+	_start_tag_lazy,
+};
+
+/*
+ * _add_projection:
+ * @self: A %GSDLStreamQuery with its path and context set.
+ * @depth: Index of the step to end the projection at.
+ * @all_attrs: Whether to pass every attribute of matching tags through, rather than just those that
+ *             are checked or picked out.
+ *
+ * Adds a projection letting through the tags matching the first @depth + 1 steps.
+ */
+static void _add_projection(GSDLStreamQuery *self, guint depth, bool all_attrs) {
+	GString *projection = g_string_new("");
+
+	for (guint i = 0; i <= depth; i++) {
+		if (i) g_string_append_c(projection, '/');
+		g_string_append(projection, self->path->steps[i].name ? self->path->steps[i].name : "*");
+	}
+
+	if (!all_attrs) {
+		const GSDLPathStep *step = &self->path->steps[depth];
+
+		for (guint i = 0; i < step->n_preds; i++) g_string_append_printf(projection, "@%s", step->preds[i].attr);
+
+		if (depth == self->path->n_steps - 1) {
+			for (char **attr = self->path->attrs; *attr; attr++) g_string_append_printf(projection, "@%s", *attr);
+		}
+	}
+
+	bool success = gsdl_parser_context_add_projection(self->context, projection->str, NULL);
+	g_assert(success);
+
+	g_string_free(projection, TRUE);
+}
+
+//> Public Functions
+/**
+ * gsdl_stream_query_new:
+ * @path: A path, as for gsdl_query_compile().
+ * @parser: The callbacks to pass matches and errors to. Only %start_tag_block (for each matching
+ *          tag), which must be set, and %error are used.
+ * @user_data: Data to pass to @parser's callbacks.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Creates a query to run against any number of documents, one after another, with the
+ * #GSDLParserContext returned by gsdl_stream_query_get_context().
+ *
+ * Each matching tag is passed to %start_tag_block with its values, and either all of its
+ * attributes or, if @path picks some out, just those (in the order they appear in the tag). Its
+ * children are always skipped.
+ *
+ * Returns: A new #GSDLStreamQuery, to be freed with gsdl_stream_query_free(), or %NULL if @path was
+ *          not valid. If so, the error will be %GSDL_SYNTAX_ERROR_BAD_PATH.
+ */
+GSDLStreamQuery* gsdl_stream_query_new(const char *path, GSDLParser *parser, gpointer user_data, GError **err) {
+	g_return_val_if_fail(parser != NULL && parser->start_tag_block != NULL, NULL);
+
+	GSDLPath *parsed = _gsdl_path_parse(path, err);
+	if (!parsed) return NULL;
+
+	GSDLStreamQuery *self = g_slice_new(GSDLStreamQuery);
+	self->path = parsed;
+	self->context = gsdl_parser_context_new(&STREAM_PARSER, self);
+	self->parser = parser;
+	self->user_data = user_data;
+	self->values = g_array_new(FALSE, TRUE, sizeof(GValue));
+	self->attr_values = g_array_new(FALSE, TRUE, sizeof(GValue));
+	self->picked_values = g_array_new(FALSE, TRUE, sizeof(GValue));
+	self->picked_names = g_ptr_array_new();
+
+	for (guint i = 0; i < parsed->n_steps - 1; i++) {
+		if (parsed->steps[i].n_preds) _add_projection(self, i, false);
+	}
+	_add_projection(self, parsed->n_steps - 1, !parsed->attrs);
+
+	return self;
+}
+
+/**
+ * gsdl_stream_query_get_context:
+ * @self: A valid #GSDLStreamQuery.
+ *
+ * Returns: (transfer none): The context to parse with, using any of gsdl_parser_context_parse_file(),
+ *          gsdl_parser_context_parse_string() or gsdl_parser_context_feed(). It must not be given
+ *          any other projections or callbacks.
+ */
+GSDLParserContext* gsdl_stream_query_get_context(GSDLStreamQuery *self) {
+	return self->context;
+}
+
+/**
+ * gsdl_stream_query_free:
+ * @self: A valid #GSDLStreamQuery.
+ *
+ * Frees @self, along with its context.
+ */
+void gsdl_stream_query_free(GSDLStreamQuery *self) {
+	gsdl_parser_context_free(self->context);
+	_gsdl_path_free(self->path);
+
+	g_array_free(self->values, TRUE);
+	g_array_free(self->attr_values, TRUE);
+	g_array_free(self->picked_values, TRUE);
+	g_ptr_array_free(self->picked_names, TRUE);
+
+	g_slice_free(GSDLStreamQuery, self);
+}
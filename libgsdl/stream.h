@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2013 Jesse Weaver <pianohacker@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include <glib.h>
+#include <stdbool.h>
+
+#include "parser.h"
+
+/**
+ * GSDLStreamQuery:
+ *
+ * All fields in GSDLStreamQuery are private.
+ */
+typedef struct _GSDLStreamQuery GSDLStreamQuery;
+
+extern GSDLStreamQuery* gsdl_stream_query_new(const char *path, GSDLParser *parser, gpointer user_data, GError **err);
+extern GSDLParserContext* gsdl_stream_query_get_context(GSDLStreamQuery *self);
+extern void gsdl_stream_query_free(GSDLStreamQuery *self);
+
+#endif
@@ -41,8 +41,13 @@
  * @GSDL_SYNTAX_ERROR_MISSING_VALUE: Parser handler was missing a required attribute or value.
  * @GSDL_SYNTAX_ERROR_BAD_TYPE: Parser handler found a value that could not be converted to the
  *                              required type.
+ * @GSDL_SYNTAX_ERROR_TOO_DEEP: Tags were nested more deeply than the limit set with
+ *                              gsdl_parser_context_set_max_depth().
+ * @GSDL_SYNTAX_ERROR_BAD_PATH: A path given to gsdl_parser_context_add_projection(),
+ *                              gsdl_query_compile() or gsdl_stream_query_new() was malformed.
  * 
- * The last three errors are intended to be used by %GSDLParser parser callbacks.
+ * %GSDL_SYNTAX_ERROR_UNEXPECTED_TAG, %GSDL_SYNTAX_ERROR_MISSING_VALUE and
+ * %GSDL_SYNTAX_ERROR_BAD_TYPE are intended to be used by %GSDLParser parser callbacks.
  */
 typedef enum {
 	GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR,
@@ -52,6 +57,8 @@ typedef enum {
 	GSDL_SYNTAX_ERROR_UNEXPECTED_TAG,
 	GSDL_SYNTAX_ERROR_MISSING_VALUE,
 	GSDL_SYNTAX_ERROR_BAD_TYPE,
+	GSDL_SYNTAX_ERROR_TOO_DEEP,
+	GSDL_SYNTAX_ERROR_BAD_PATH,
 } GSDLSyntaxError;
 
 extern GQuark gsdl_syntax_error_quark();
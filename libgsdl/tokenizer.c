@@ -55,27 +55,69 @@
 #include <string.h>
 #include <unistd.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "idchar.h"
+#include "idtable.h"
 #include "syntax.h"
 #include "tokenizer.h"
 
 //> Macros
 #define FAIL_IF_ERR() if ((err != NULL) && (*err != NULL)) return false;
-#define GROW_IF_NEEDED(str, i, alloc) if (i >= alloc) { alloc = alloc * 2 + 1; str = g_realloc(str, alloc); }
 #define REQUIRE(expr) if (!expr) return false;
 
 //> Internal Types
 struct _GSDLTokenizer {
 	char *filename;
-	GIOChannel *channel;
-	gunichar *stringbuf;
-	
-	int line;
-	int col;
-
-	bool peek_avail;
-	gunichar peeked;
+
+	GMappedFile *mapped;
+	char *owned_buf;
+
+	// Input fed in through gsdl_tokenizer_feed(), minus anything that has already been tokenized.
+	GString *stream;
+	gsize stream_offset;
+	bool stream_open;
+	bool starved;
+
+	const char *buf;
+	const char *pos;
+	const char *end;
+	bool buf_done;
+
+	GPtrArray *batch_owned;
+
+	// Line and column numbers are only worked out when needed, by counting newlines forward from
+	// the anchor. The offsets of the newlines seen so far are kept in a sorted index.
+	gsize anchor_offset;
+	guint anchor_line;
+	guint anchor_col;
+	GArray *newlines;
+	gsize indexed_end;
 };
 
+// What a token can be, judging by its first byte.
+typedef enum {
+	CLASS_INVALID,
+	CLASS_BLANK,
+	CLASS_CR,
+	CLASS_PUNCT,
+	CLASS_SLASH,
+	CLASS_DASH,
+	CLASS_HASH,
+	CLASS_BACKSLASH,
+	CLASS_DIGIT,
+	CLASS_IDENTIFIER,
+	CLASS_BINARY,
+	CLASS_STRING,
+	CLASS_BACKQUOTE_STRING,
+	CLASS_CHAR,
+	// The first byte of a multi-byte character, which has to be decoded to be classified.
+	CLASS_UNICODE,
+} CharClass;
+
 //> Static Data
 static char *TOKEN_NAMES[15] = {
 	"EOF",
@@ -95,6 +137,537 @@ static char *TOKEN_NAMES[15] = {
 	"binary",
 };
 
+// Size of each read when a file cannot be mapped.
+#define READ_BLOCK_SIZE 65536
+
+//> Scanning Kernels
+// These are used to jump over long runs of bytes that need no interpretation: string bodies,
+// comments, and the line/column bookkeeping for both. Each has a scalar version, and SSE2 and AVX2
+// versions selected at runtime by _scan_init().
+typedef struct {
+	// Returns the first byte in [p, end) that is either a or b, or end.
+	const char* (*find2)(const char *p, const char *end, char a, char b);
+	// Returns the number of times c occurs in [p, end).
+	gsize (*count_byte)(const char *p, const char *end, char c);
+	// Returns the number of UTF-8 characters (non-continuation bytes) in [p, end).
+	gsize (*count_chars)(const char *p, const char *end);
+	// Decodes groups of four base64 characters from [p, end) into out, stopping at the first group
+	// that contains anything else (whitespace or padding included). Returns the number of characters
+	// decoded; out must have room for three bytes for every four characters, plus 32.
+	gsize (*decode_base64)(const char *p, const char *end, guchar *out);
+} ScanKernels;
+
+static ScanKernels _scan;
+
+// Maps each byte to its base64 value, or one of these.
+#define BASE64_SPACE 0x40
+#define BASE64_INVALID 0x80
+static guchar BASE64_VALUES[256];
+
+// Maps the first byte of each token to its %CharClass.
+static guchar CHAR_CLASSES[256];
+
+static const char* _find2_scalar(const char *p, const char *end, char a, char b) {
+	for (; p < end; p++) if (*p == a || *p == b) break;
+
+	return p;
+}
+
+static gsize _count_byte_scalar(const char *p, const char *end, char c) {
+	gsize result = 0;
+
+	for (; p < end; p++) result += *p == c;
+
+	return result;
+}
+
+static gsize _count_chars_scalar(const char *p, const char *end) {
+	gsize result = 0;
+
+	for (; p < end; p++) result += (*p & 0xc0) != 0x80;
+
+	return result;
+}
+
+static gsize _decode_base64_scalar(const char *p, const char *end, guchar *out) {
+	const char *start = p;
+
+	for (; end - p >= 4; p += 4, out += 3) {
+		guint32 a = BASE64_VALUES[(guchar) p[0]], b = BASE64_VALUES[(guchar) p[1]], c = BASE64_VALUES[(guchar) p[2]], d = BASE64_VALUES[(guchar) p[3]];
+
+		if ((a | b | c | d) >= 64) break;
+
+		guint32 group = a << 18 | b << 12 | c << 6 | d;
+		out[0] = group >> 16;
+		out[1] = group >> 8;
+		out[2] = group;
+	}
+
+	return p - start;
+}
+
+#ifdef HAVE_X86_KERNELS
+__attribute__((target("sse2")))
+static const char* _find2_sse2(const char *p, const char *end, char a, char b) {
+	__m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b);
+
+	for (; end - p >= 16; p += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*) p);
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+
+		if (mask) return p + __builtin_ctz(mask);
+	}
+
+	return _find2_scalar(p, end, a, b);
+}
+
+__attribute__((target("sse2")))
+static gsize _count_byte_sse2(const char *p, const char *end, char c) {
+	__m128i vc = _mm_set1_epi8(c);
+	gsize result = 0;
+
+	for (; end - p >= 16; p += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*) p);
+		result += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vc)));
+	}
+
+	return result + _count_byte_scalar(p, end, c);
+}
+
+__attribute__((target("sse2")))
+static gsize _count_chars_sse2(const char *p, const char *end) {
+	// Continuation bytes are 0x80-0xbf, which are exactly the bytes below 0xc0 when signed.
+	__m128i limit = _mm_set1_epi8((char) 0xc0);
+	gsize result = 0;
+
+	for (; end - p >= 16; p += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*) p);
+		result += 16 - __builtin_popcount(_mm_movemask_epi8(_mm_cmplt_epi8(chunk, limit)));
+	}
+
+	return result + _count_chars_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* _find2_avx2(const char *p, const char *end, char a, char b) {
+	__m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b);
+
+	for (; end - p >= 32; p += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+		unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb)));
+
+		if (mask) return p + __builtin_ctz(mask);
+	}
+
+	return _find2_sse2(p, end, a, b);
+}
+
+__attribute__((target("avx2")))
+static gsize _count_byte_avx2(const char *p, const char *end, char c) {
+	__m256i vc = _mm256_set1_epi8(c);
+	gsize result = 0;
+
+	for (; end - p >= 32; p += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+		result += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vc)));
+	}
+
+	return result + _count_byte_sse2(p, end, c);
+}
+
+__attribute__((target("avx2")))
+static gsize _count_chars_avx2(const char *p, const char *end) {
+	__m256i limit = _mm256_set1_epi8((char) 0xc0);
+	gsize result = 0;
+
+	for (; end - p >= 32; p += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+		result += 32 - __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, chunk)));
+	}
+
+	return result + _count_chars_sse2(p, end);
+}
+
+// Based on the AVX2 decoder by Wojciech Muła and Daniel Lemire: classifies each character by its
+// nibbles with table lookups, then packs 32 6-bit values into 24 bytes.
+__attribute__((target("avx2")))
+static gsize _decode_base64_avx2(const char *p, const char *end, guchar *out) {
+	const __m256i lut_lo = _mm256_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+	);
+	const __m256i lut_hi = _mm256_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	);
+	const __m256i lut_roll = _mm256_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+	);
+	const __m256i pack_shuffle = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+	);
+	const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+	const char *start = p;
+
+	for (; end - p >= 32; p += 32, out += 24) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+
+		__m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(chunk, 4), mask_2f);
+		__m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(chunk, mask_2f));
+		__m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+
+		// Anything outside of the alphabet has a bit set in both lookups.
+		if (!_mm256_testz_si256(lo, hi)) break;
+
+		__m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(chunk, mask_2f), hi_nibbles));
+		chunk = _mm256_add_epi8(chunk, roll);
+
+		// Merge pairs of 6-bit values into 12 bits, then pairs of those into 24.
+		chunk = _mm256_maddubs_epi16(chunk, _mm256_set1_epi32(0x01400140));
+		chunk = _mm256_madd_epi16(chunk, _mm256_set1_epi32(0x00011000));
+		chunk = _mm256_shuffle_epi8(chunk, pack_shuffle);
+		chunk = _mm256_permutevar8x32_epi32(chunk, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+
+		_mm256_storeu_si256((__m256i*) out, chunk);
+	}
+
+	return (p - start) + _decode_base64_scalar(p, end, out);
+}
+#endif
+
+/*
+ * _scan_init:
+ *
+ * Picks the fastest set of scanning kernels supported by the CPU, and fills in the lookup tables.
+ *
+ * Safe to call from several threads at once; only the first call does any work.
+ */
+static void _scan_init() {
+	static volatile gsize init_done = 0;
+	if (!g_once_init_enter(&init_done)) return;
+
+	static const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	memset(BASE64_VALUES, BASE64_INVALID, sizeof(BASE64_VALUES));
+	for (int i = 0; i < 64; i++) BASE64_VALUES[(guchar) BASE64_ALPHABET[i]] = i;
+	BASE64_VALUES[' '] = BASE64_VALUES['\t'] = BASE64_VALUES['\r'] = BASE64_VALUES['\n'] = BASE64_SPACE;
+
+	memset(CHAR_CLASSES, CLASS_INVALID, 0x80);
+	memset(CHAR_CLASSES + 0x80, CLASS_UNICODE, 0x80);
+	for (int c = 0; c < 0x80; c++) {
+		if (g_ascii_isalpha(c)) CHAR_CLASSES[c] = CLASS_IDENTIFIER;
+		if (g_ascii_isdigit(c)) CHAR_CLASSES[c] = CLASS_DIGIT;
+	}
+	for (const char *c = "+:;.{}=\n"; *c; c++) CHAR_CLASSES[(guchar) *c] = CLASS_PUNCT;
+	CHAR_CLASSES['_'] = CHAR_CLASSES['$'] = CLASS_IDENTIFIER;
+	CHAR_CLASSES[' '] = CHAR_CLASSES['\t'] = CLASS_BLANK;
+	CHAR_CLASSES['\r'] = CLASS_CR;
+	CHAR_CLASSES['/'] = CLASS_SLASH;
+	CHAR_CLASSES['-'] = CLASS_DASH;
+	CHAR_CLASSES['#'] = CLASS_HASH;
+	CHAR_CLASSES['\\'] = CLASS_BACKSLASH;
+	CHAR_CLASSES['['] = CLASS_BINARY;
+	CHAR_CLASSES['"'] = CLASS_STRING;
+	CHAR_CLASSES['`'] = CLASS_BACKQUOTE_STRING;
+	CHAR_CLASSES['\''] = CLASS_CHAR;
+
+	_scan = (ScanKernels) { _find2_scalar, _count_byte_scalar, _count_chars_scalar, _decode_base64_scalar };
+
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		_scan = (ScanKernels) { _find2_avx2, _count_byte_avx2, _count_chars_avx2, _decode_base64_avx2 };
+	} else if (__builtin_cpu_supports("sse2")) {
+		_scan = (ScanKernels) { _find2_sse2, _count_byte_sse2, _count_chars_sse2, _decode_base64_scalar };
+	}
+#endif
+
+	g_once_init_leave(&init_done, 1);
+}
+
+//> Internal Setup Functions
+/*
+ * _set_buffer:
+ * @self: A %GSDLTokenizer with no input.
+ * @buf: Start of the input.
+ * @len: Length of the input in bytes, or -1 if @buf is %NULL-terminated.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Validates the input as UTF-8 and points the tokenizer's cursor at it.
+ *
+ * Returns: Whether the input was valid.
+ */
+static bool _set_buffer(GSDLTokenizer *self, const char *buf, gssize len, GError **err) {
+	const char *end;
+
+	if (!g_utf8_validate(buf, len, &end)) {
+		g_set_error(err,
+			G_CONVERT_ERROR,
+			G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+			"Invalid byte sequence in conversion input"
+		);
+
+		return false;
+	}
+
+	_scan_init();
+
+	self->buf = self->pos = buf;
+	self->end = end;
+	self->buf_done = false;
+
+	return true;
+}
+
+// Pointer to the given offset from the start of the input, which must not have been thrown away.
+#define _AT(self, offset) ((self)->buf + ((offset) - (self)->stream_offset))
+
+/*
+ * _location:
+ * @self: A valid %GSDLTokenizer.
+ * @offset: An offset in the input, at or after the anchor.
+ * @line: (out): Location to store the line number.
+ * @col: (out): Location to store the column number, in characters.
+ *
+ * Works out the line and column of a position in the input, extending the newline index as far as
+ * needed.
+ */
+static void _location(GSDLTokenizer *self, gsize offset, guint *line, guint *col) {
+	g_assert(offset >= self->anchor_offset);
+
+	if (offset > self->indexed_end) {
+		const char *p = _AT(self, self->indexed_end), *stop = _AT(self, offset);
+
+		while ((p = _scan.find2(p, stop, '\n', '\n')) < stop) {
+			gsize newline = self->stream_offset + (p++ - self->buf);
+			g_array_append_val(self->newlines, newline);
+		}
+
+		self->indexed_end = offset;
+	}
+
+	// Find the number of newlines before offset.
+	guint low = 0, high = self->newlines->len;
+	while (low < high) {
+		guint mid = (low + high) / 2;
+
+		if (g_array_index(self->newlines, gsize, mid) < offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == 0) {
+		*line = self->anchor_line;
+		*col = self->anchor_col + _scan.count_chars(_AT(self, self->anchor_offset), _AT(self, offset));
+	} else {
+		*line = self->anchor_line + low;
+		*col = 1 + _scan.count_chars(_AT(self, g_array_index(self->newlines, gsize, low - 1) + 1), _AT(self, offset));
+	}
+}
+
+/*
+ * _validate_stream:
+ * @self: A push-mode %GSDLTokenizer.
+ * @valid: Number of bytes after the cursor that have already been validated.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Validates newly fed input, and points the tokenizer at the (possibly moved) stream buffer. An
+ * incomplete character at the end of the input is left outside of the buffer until the rest of it
+ * is fed in.
+ *
+ * Returns: Whether the input was valid.
+ */
+static bool _validate_stream(GSDLTokenizer *self, gsize valid, GError **err) {
+	const char *start = self->stream->str + valid, *stream_end = self->stream->str + self->stream->len, *end;
+
+	if (!g_utf8_validate(start, stream_end - start, &end) && !(self->stream_open && *end && g_utf8_get_char_validated(end, stream_end - end) == (gunichar) -2)) {
+		g_set_error(err,
+			G_CONVERT_ERROR,
+			G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+			"Invalid byte sequence in conversion input"
+		);
+
+		return false;
+	}
+
+	self->buf = self->pos = self->stream->str;
+	self->end = end;
+
+	return true;
+}
+
+/*
+ * _read_blocks:
+ * @filename: Name of the file to read.
+ * @len: (out): Location to store the number of bytes read.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Reads the entirety of a file that could not be mapped (a pipe, for instance), in large blocks.
+ *
+ * Returns: A newly-allocated buffer with the contents of the file, or %NULL on failure.
+ */
+static char* _read_blocks(const char *filename, gsize *len, GError **err) {
+	GIOChannel *channel = g_io_channel_new_file(filename, "r", err);
+	if (!channel) return NULL;
+
+	g_io_channel_set_encoding(channel, NULL, NULL);
+
+	gsize alloc = READ_BLOCK_SIZE, bytes_read;
+	char *result = g_malloc(alloc);
+	*len = 0;
+
+	for (;;) {
+		if (alloc - *len < READ_BLOCK_SIZE) {
+			alloc *= 2;
+			result = g_realloc(result, alloc);
+		}
+
+		switch (g_io_channel_read_chars(channel, result + *len, READ_BLOCK_SIZE, &bytes_read, err)) {
+			case G_IO_STATUS_ERROR:
+				g_free(result);
+				g_io_channel_unref(channel);
+				return NULL;
+			case G_IO_STATUS_EOF:
+				g_io_channel_shutdown(channel, FALSE, NULL);
+				g_io_channel_unref(channel);
+				return result;
+			case G_IO_STATUS_AGAIN:
+			case G_IO_STATUS_NORMAL:
+				*len += bytes_read;
+				break;
+		}
+	}
+}
+
+/*
+ * _gsdl_tokenizer_new:
+ *
+ * Used by the parser, which keeps a single tokenizer around and gives it new input for each parse.
+ *
+ * Returns: A new %GSDLTokenizer with no input yet.
+ */
+GSDLTokenizer* _gsdl_tokenizer_new() {
+	GSDLTokenizer* self = g_slice_new0(GSDLTokenizer);
+	self->batch_owned = g_ptr_array_new_with_free_func(g_free);
+	self->newlines = g_array_new(FALSE, FALSE, sizeof(gsize));
+	self->anchor_line = self->anchor_col = 1;
+	self->buf_done = true;
+
+	return self;
+}
+
+/*
+ * _gsdl_tokenizer_close:
+ * @self: A valid %GSDLTokenizer.
+ *
+ * Throws away the tokenizer's input, and anything that was read from it. Its buffers are kept, so
+ * that tokenizing the next input does not have to allocate them again.
+ */
+void _gsdl_tokenizer_close(GSDLTokenizer *self) {
+	if (self->mapped) g_mapped_file_unref(self->mapped);
+	self->mapped = NULL;
+	g_free(self->owned_buf);
+	self->owned_buf = NULL;
+
+	if (self->stream) g_string_truncate(self->stream, 0);
+	self->stream_offset = 0;
+	self->stream_open = self->starved = false;
+
+	self->buf = self->pos = self->end = NULL;
+	self->buf_done = true;
+
+	g_ptr_array_set_size(self->batch_owned, 0);
+
+	self->anchor_offset = self->indexed_end = 0;
+	self->anchor_line = self->anchor_col = 1;
+	g_array_set_size(self->newlines, 0);
+}
+
+/*
+ * _set_filename:
+ * @self: A valid %GSDLTokenizer.
+ * @filename: Name to report in error messages.
+ */
+static void _set_filename(GSDLTokenizer *self, const char *filename) {
+	if (self->filename && strcmp(self->filename, filename) == 0) return;
+
+	g_free(self->filename);
+	self->filename = g_strdup(filename);
+}
+
+/*
+ * _gsdl_tokenizer_open_file:
+ * @self: A valid %GSDLTokenizer.
+ * @filename: Name of file to be parsed.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Closes the tokenizer's current input, and starts tokenizing the given file instead. See
+ * gsdl_tokenizer_new().
+ *
+ * Returns: Whether the file could be read.
+ */
+bool _gsdl_tokenizer_open_file(GSDLTokenizer *self, const char *filename, GError **err) {
+	_gsdl_tokenizer_close(self);
+	_set_filename(self, filename);
+
+	const char *buf;
+	gsize len;
+	GError *map_err = NULL;
+
+	if ((self->mapped = g_mapped_file_new(filename, FALSE, &map_err))) {
+		len = g_mapped_file_get_length(self->mapped);
+		// Empty files have no mapping at all.
+		buf = len ? g_mapped_file_get_contents(self->mapped) : "";
+	} else {
+		g_error_free(map_err);
+
+		if (!(self->owned_buf = _read_blocks(filename, &len, err))) return false;
+		buf = self->owned_buf;
+	}
+
+	return _set_buffer(self, buf, len, err);
+}
+
+/*
+ * _gsdl_tokenizer_open_string:
+ * @self: A valid %GSDLTokenizer.
+ * @str: String to be parsed.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Closes the tokenizer's current input, and starts tokenizing the given string instead. See
+ * gsdl_tokenizer_new_from_string().
+ *
+ * Returns: Whether the string was valid UTF-8.
+ */
+bool _gsdl_tokenizer_open_string(GSDLTokenizer *self, const char *str, GError **err) {
+	_gsdl_tokenizer_close(self);
+	_set_filename(self, "<string>");
+
+	return _set_buffer(self, str, -1, err);
+}
+
+/*
+ * _gsdl_tokenizer_open_push:
+ * @self: A valid %GSDLTokenizer.
+ *
+ * Closes the tokenizer's current input, and switches it to push mode. See gsdl_tokenizer_new_push().
+ */
+void _gsdl_tokenizer_open_push(GSDLTokenizer *self) {
+	_gsdl_tokenizer_close(self);
+	_set_filename(self, "<stream>");
+	_scan_init();
+
+	if (!self->stream) self->stream = g_string_new("");
+	self->stream_open = true;
+	self->buf = self->pos = self->end = self->stream->str;
+	self->buf_done = false;
+}
+
 //> Public Functions
 
 /**
@@ -104,19 +677,18 @@ static char *TOKEN_NAMES[15] = {
  *
  * Creates a new tokenizer consuming the given file.
  *
+ * The file is memory-mapped if possible, and otherwise read in up front in large blocks. Either way,
+ * it is then tokenized exactly like a string passed to gsdl_tokenizer_new_from_string().
+ *
  * Returns: A new %GSDLTokenizer, or NULL on failure.
  */
 GSDLTokenizer* gsdl_tokenizer_new(const char *filename, GError **err) {
-	GSDLTokenizer* self = g_slice_new0(GSDLTokenizer);
-	self->filename = g_strdup(filename);
-	self->channel = g_io_channel_new_file(filename, "r", err);
-
-	if (!self->channel) return NULL;
+	GSDLTokenizer* self = _gsdl_tokenizer_new();
 
-	self->stringbuf = NULL;
-	self->line = 1;
-	self->col = 1;
-	self->peek_avail = false;
+	if (!_gsdl_tokenizer_open_file(self, filename, err)) {
+		gsdl_tokenizer_free(self);
+		return NULL;
+	}
 
 	return self;
 }
@@ -128,23 +700,111 @@ GSDLTokenizer* gsdl_tokenizer_new(const char *filename, GError **err) {
  *
  * Creates a new tokenizer consuming the given string. The filename will be set to "&lt;string&gt;".
  *
+ * The string is tokenized in place, and must stay valid until the tokenizer is freed. It is checked
+ * for valid UTF-8 up front, but is otherwise never copied or converted.
+ *
  * Returns: A new %GSDLTokenizer, or NULL on failure.
  */
 GSDLTokenizer* gsdl_tokenizer_new_from_string(const char *str, GError **err) {
-	GSDLTokenizer* self = g_slice_new0(GSDLTokenizer);
-	self->filename = "<string>";
-	self->stringbuf = g_utf8_to_ucs4(str, -1, NULL, NULL, err);
+	GSDLTokenizer* self = _gsdl_tokenizer_new();
+
+	if (!_gsdl_tokenizer_open_string(self, str, err)) {
+		gsdl_tokenizer_free(self);
+		return NULL;
+	}
+
+	return self;
+}
 
-	if (!self->stringbuf) return NULL;
+/**
+ * gsdl_tokenizer_new_push:
+ *
+ * Creates a new tokenizer that has its input fed to it in chunks, with gsdl_tokenizer_feed(). The
+ * filename will be set to "&lt;stream&gt;".
+ *
+ * When a push-mode tokenizer runs out of input in the middle of a token, gsdl_tokenizer_next() and
+ * gsdl_tokenizer_next_batch() return %FALSE without setting an error, and will pick up from the
+ * start of that token once more input is fed in. Once gsdl_tokenizer_end() has been called, it
+ * behaves like any other tokenizer.
+ *
+ * Returns: A new %GSDLTokenizer.
+ */
+GSDLTokenizer* gsdl_tokenizer_new_push() {
+	GSDLTokenizer* self = _gsdl_tokenizer_new();
 
-	self->channel = NULL;
-	self->line = 1;
-	self->col = 1;
-	self->peek_avail = false;
+	_gsdl_tokenizer_open_push(self);
 
 	return self;
 }
 
+/**
+ * gsdl_tokenizer_feed:
+ * @self: A %GSDLTokenizer created with gsdl_tokenizer_new_push().
+ * @buf: The next chunk of UTF-8 encoded input. May end in the middle of a token or character.
+ * @len: Length of @buf in bytes.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Adds more input to the end of a push-mode tokenizer. @buf is copied, and does not have to stay
+ * valid after this call.
+ *
+ * Input that has already been tokenized is thrown away, so the values of any tokens read before
+ * this call are no longer valid.
+ *
+ * Returns: Whether the input was valid UTF-8.
+ */
+bool gsdl_tokenizer_feed(GSDLTokenizer *self, const char *buf, gsize len, GError **err) {
+	g_return_val_if_fail(self->stream && self->stream_open, false);
+
+	gsize consumed = self->pos - self->buf, valid = self->end - self->pos;
+
+	if (consumed) {
+		// Move the anchor up to the new start of the buffer, as nothing before it can be looked up
+		// anymore.
+		gsize anchor = self->stream_offset + consumed;
+		guint line, col;
+
+		_location(self, anchor, &line, &col);
+		self->anchor_offset = self->indexed_end = anchor;
+		self->anchor_line = line;
+		self->anchor_col = col;
+		g_array_set_size(self->newlines, 0);
+	}
+
+	g_string_erase(self->stream, 0, consumed);
+	self->stream_offset += consumed;
+	g_string_append_len(self->stream, buf, len);
+
+	return _validate_stream(self, valid, err);
+}
+
+/**
+ * gsdl_tokenizer_end:
+ * @self: A %GSDLTokenizer created with gsdl_tokenizer_new_push().
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Marks the end of the input to a push-mode tokenizer; the remaining tokens, up to and including
+ * %T_EOF, can then be read.
+ *
+ * Returns: Whether the input ended on a complete UTF-8 character.
+ */
+bool gsdl_tokenizer_end(GSDLTokenizer *self, GError **err) {
+	g_return_val_if_fail(self->stream && self->stream_open, false);
+
+	self->stream_open = false;
+
+	if (self->end != self->stream->str + self->stream->len) {
+		g_set_error(err,
+			G_CONVERT_ERROR,
+			G_CONVERT_ERROR_PARTIAL_INPUT,
+			"Partial character sequence at end of input"
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
 /**
  * gsdl_tokenizer_get_filename:
  * @self: A valid %GSDLTokenizer.
@@ -155,6 +815,22 @@ char* gsdl_tokenizer_get_filename(GSDLTokenizer *self) {
 	return self->filename;
 }
 
+/**
+ * gsdl_tokenizer_get_location:
+ * @self: A valid %GSDLTokenizer.
+ * @offset: The offset of a token from this %GSDLTokenizer. For a push-mode tokenizer, the token
+ *          must have been read since input was last fed to it.
+ * @line: (out): Location to store the line the token is on, starting from 1.
+ * @col: (out): Location to store the column of the start of the token, in characters, starting
+ *       from 1.
+ *
+ * Works out where a token is in the input. This is only done on demand, so it is cheap to keep
+ * tokens around, and a little more expensive to look at their locations.
+ */
+void gsdl_tokenizer_get_location(GSDLTokenizer *self, gsize offset, guint *line, guint *col) {
+	_location(self, offset, line, col);
+}
+
 /**
  * gsdl_tokenizer_free:
  * @self: A valid %GSDLTokenizer.
@@ -164,12 +840,11 @@ char* gsdl_tokenizer_get_filename(GSDLTokenizer *self) {
 void gsdl_tokenizer_free(GSDLTokenizer *self) {
 	g_free(self->filename);
 
-	if (self->channel) {
-		g_io_channel_shutdown(self->channel, FALSE, NULL);
-		g_io_channel_unref(self->channel);
-	}
-
-	if (self->stringbuf) g_free(self->stringbuf);
+	if (self->mapped) g_mapped_file_unref(self->mapped);
+	if (self->stream) g_string_free(self->stream, TRUE);
+	g_free(self->owned_buf);
+	g_ptr_array_unref(self->batch_owned);
+	g_array_unref(self->newlines);
 
 	g_slice_free(GSDLTokenizer, self);
 }
@@ -199,12 +874,29 @@ extern char* gsdl_token_type_name(GSDLTokenType token_type) {
  * Should be called to free a token and its contents once the parser is done with it.
  */
 extern void gsdl_token_free(GSDLToken *token) {
-	if (token->val) g_free(token->val);
+	g_free(token->_owned);
 
 	g_slice_free(GSDLToken, token);
 }
 
 //> Internal Functions
+// Byte length of the (valid) UTF-8 sequence starting at p.
+#define _CHAR_WIDTH(p) (*(const guchar*) (p) < 0x80 ? 1 : g_utf8_skip[*(const guchar*) (p)])
+
+/*
+ * _decode:
+ * @p: Pointer to the start of a valid UTF-8 sequence.
+ *
+ * Decodes a single character, only calling into GLib for multi-byte sequences.
+ *
+ * Returns: The decoded %gunichar.
+ */
+static inline gunichar _decode(const char *p) {
+	guchar c = *(const guchar*) p;
+
+	return G_LIKELY(c < 0x80) ? c : g_utf8_get_char(p);
+}
+
 /*
  * _read:
  * @self: A valid %GSDLTokenizer.
@@ -216,46 +908,26 @@ extern void gsdl_token_free(GSDLToken *token) {
  * Returns: Whether the read succeeded.
  */
 static bool _read(GSDLTokenizer *self, gunichar *result, GError **err) {
-	if (self->peek_avail) {
-		*result = self->peeked;
-		self->peek_avail = false;
-	} else if (self->stringbuf) {
-		if (!*self->stringbuf) {
-			self->stringbuf = NULL;
+	if (G_UNLIKELY(self->pos >= self->end)) {
+		if (self->stream_open) {
+			// More input may still arrive; _next() will back out of this token.
+			self->starved = true;
 			*result = EOF;
-		} else {
-			*result = *(self->stringbuf++);
+
+			return true;
 		}
 
-		return true;
-	} else {
-		if (G_UNLIKELY(!self->channel)) return false;
+		if (self->buf_done) return false;
 
-		switch (g_io_channel_read_unichar(self->channel, result, err)) {
-			case G_IO_STATUS_ERROR:
-				self->channel = NULL;
-				self->peek_avail = false;
-				return false;
-			case G_IO_STATUS_EOF:
-				self->peek_avail = false;
-				*result = EOF;
-				g_io_channel_shutdown(self->channel, FALSE, NULL);
-				g_io_channel_unref(self->channel);
-				self->channel = NULL;
-				return true;
-			case G_IO_STATUS_AGAIN:
-			case G_IO_STATUS_NORMAL:
-				break;
-		}
-	}
+		self->buf_done = true;
+		*result = EOF;
 
-	if (*result == '\n') {
-		self->line++;
-		self->col = 1;
-	} else {
-		self->col++;
+		return true;
 	}
 
+	*result = _decode(self->pos);
+	self->pos += _CHAR_WIDTH(self->pos);
+
 	return true;
 }
 
@@ -267,41 +939,18 @@ static bool _read(GSDLTokenizer *self, gunichar *result, GError **err) {
  *
  * Looks at the next UTF-8 character from the input. Will return %EOF at the end of the input.
  *
- * Returns: Whether the peek succeeded. This should always be checked, as _peek() may or may not
- *          have to read from the input.
+ * Returns: Whether the peek succeeded.
  */
 static bool _peek(GSDLTokenizer *self, gunichar *result, GError **err) {
-	if (!self->peek_avail) {
-		if (self->stringbuf) {
-			if (*self->stringbuf) {
-				self->peeked = *(self->stringbuf++);
-			} else {
-				self->stringbuf = NULL;
-				self->peeked = EOF;
-			}
-			self->peek_avail = true;
-		} else {
-			if (self->channel == NULL) return false;
-
-			switch (g_io_channel_read_unichar(self->channel, &(self->peeked), err)) {
-				case G_IO_STATUS_ERROR:
-					self->channel = NULL;
-					self->peek_avail = false;
-					return false;
-				case G_IO_STATUS_EOF:
-					self->peeked = EOF;
-					g_io_channel_shutdown(self->channel, FALSE, NULL);
-					g_io_channel_unref(self->channel);
-					self->channel = NULL;
-				case G_IO_STATUS_AGAIN:
-				case G_IO_STATUS_NORMAL:
-				default:
-					self->peek_avail = true;
-			}
-		}
+	if (G_UNLIKELY(self->buf_done)) return false;
+
+	if (G_LIKELY(self->pos < self->end)) {
+		*result = _decode(self->pos);
+	} else {
+		if (self->stream_open) self->starved = true;
+		*result = EOF;
 	}
 
-	*result = self->peeked;
 	return true;
 }
 
@@ -313,7 +962,7 @@ static bool _peek(GSDLTokenizer *self, gunichar *result, GError **err) {
  * but needs to be moved past.
  */
 static void _consume(GSDLTokenizer *self) {
-	g_assert(self->peek_avail);
+	g_assert(!self->buf_done);
 
 	gunichar result;
 	_read(self, &result, NULL);
@@ -321,20 +970,18 @@ static void _consume(GSDLTokenizer *self) {
 
 /*
  * _maketoken:
+ * @self: A valid %GSDLTokenizer.
+ * @result: The %GSDLToken to fill in.
  * @type: A valid %GSDLTokenType.
- * @line: Line where the token occurred.
- * @col: Column of the start of the token.
+ * @start: Where the token starts in the input.
  *
- * Returns: A newly-allocated %GSDLToken with the given information.
+ * Initializes @result with the given information and no value.
  */
-static GSDLToken* _maketoken(GSDLTokenType type, int line, int col) {
-	GSDLToken *result = g_slice_new0(GSDLToken);
-
-	result->type = type;
-	result->line = line;
-	result->col = col;
-
-	return result;
+static void _maketoken(GSDLTokenizer *self, GSDLToken *result, GSDLTokenType type, const char *start) {
+	*result = (GSDLToken) {
+		.type = type,
+		.offset = self->stream_offset + (start - self->buf),
+	};
 }
 
 /*
@@ -348,48 +995,78 @@ static GSDLToken* _maketoken(GSDLTokenType type, int line, int col) {
  * Sets a %GError in the %GSDL_SYNTAX_ERROR domain.
  */
 static void _set_error(GError **err, GSDLTokenizer *self, GSDLSyntaxError err_type, char *msg) {
+	guint line, col;
+	_location(self, self->stream_offset + (self->pos - self->buf), &line, &col);
+
 	g_set_error(err,
 		GSDL_SYNTAX_ERROR,
 		err_type,
 		"%s in %s, line %d, column %d",
 		msg,
 		self->filename,
-		self->line,
-		self->col
+		line,
+		col
 	);
 }
 
 //> Sub-tokenizers
-static bool _tokenize_number(GSDLTokenizer *self, GSDLToken *result, gunichar c, GError **err) {
-	int length = 7;
-	char *output = result->val = g_malloc(length);
+// Whether an ASCII character may continue an identifier.
+#define _IS_ASCII_IDENTIFIER_CHAR(c) ((ID_ASCII[(c) >> 5] >> ((c) & 31)) & 1)
 
-	output[0] = c;
-	int i = 1;
+/*
+ * _is_identifier_char:
+ * @c: Any Unicode character.
+ *
+ * Checks whether @c may continue an identifier, using the tables generated by gen-idtable for the
+ * Basic Multilingual Plane.
+ *
+ * Returns: Whether @c may appear after the first character of an identifier.
+ */
+static inline bool _is_identifier_char(gunichar c) {
+	if (G_LIKELY(c < 0x10000)) return (ID_BLOCKS[ID_BLOCK_INDEX[c >> 8]][(c >> 5) & 7] >> (c & 31)) & 1;
 
-	while (_peek(self, &c, err) && c < 256 && isdigit(c)) {
-		GROW_IF_NEEDED(output = result->val, i + 1, length);
+	return _gsdl_unichar_is_identifier(c);
+}
 
-		_consume(self);
-		output[i++] = (gunichar) c;
-	}
+/*
+ * _gsdl_tokenizer_is_identifier_char:
+ * @c: Any Unicode character.
+ *
+ * Exported for the tests, to check the generated tables against _gsdl_unichar_is_identifier().
+ *
+ * Returns: Whether @c may appear after the first character of an identifier.
+ */
+bool _gsdl_tokenizer_is_identifier_char(gunichar c) {
+	return _is_identifier_char(c);
+}
 
-	FAIL_IF_ERR();
+static bool _slice_equal(const char *val, gsize len, const char *str) {
+	return strncmp(val, str, len) == 0 && str[len] == '\0';
+}
 
-	char *suffix = output + i;
+static bool _tokenize_number(GSDLTokenizer *self, GSDLToken *result, GError **err) {
+	// The first digit has already been read.
+	const char *p = result->val = self->pos - 1;
+	guint64 num = 0;
 
-	while (_peek(self, &c, err) && c < 256 && (isalpha(c) || isdigit(c))) {
-		GROW_IF_NEEDED(output = result->val, i + 1, length);
+	for (; p < self->end && g_ascii_isdigit(*p); p++) {
+		guint digit = *p - '0';
 
-		_consume(self);
-		output[i++] = (gunichar) c;
+		// Saturates, so the parser can tell when a number is out of range.
+		num = num > (G_MAXUINT64 - digit) / 10 ? G_MAXUINT64 : num * 10 + digit;
 	}
+	result->len = p - result->val;
+	result->num = num;
 
-	FAIL_IF_ERR();
+	const char *suffix = p;
+	while (p < self->end && g_ascii_isalnum(*p)) p++;
+	gsize suffix_len = p - suffix;
 
-	output[i] = '\0';
+	self->pos = p;
+	if (p == self->end && self->stream_open) self->starved = true;
+	char c = p < self->end ? *p : '\0';
 
-	if (*suffix == '\0') {
+	if (suffix_len == 0) {
 		// Just a T_NUMBER
 
 		if (c == ':') {
@@ -401,9 +1078,9 @@ static bool _tokenize_number(GSDLTokenizer *self, GSDLToken *result, gunichar c,
 
 			result->type = T_DATE_PART;
 		}
-	} else if (strcasecmp("bd", suffix) == 0) {
+	} else if (suffix_len == 2 && g_ascii_strncasecmp("bd", suffix, 2) == 0) {
 		result->type = T_DECIMAL_END;
-	} else if (strcasecmp("d", suffix) == 0) {
+	} else if (suffix_len == 1 && g_ascii_tolower(*suffix) == 'd') {
 		if (c == ':') {
 			_consume(self);
 
@@ -411,288 +1088,781 @@ static bool _tokenize_number(GSDLTokenizer *self, GSDLToken *result, gunichar c,
 		} else {
 			result->type = T_DOUBLE_END;
 		}
-	} else if (strcasecmp("f", suffix) == 0) {
+	} else if (suffix_len == 1 && g_ascii_tolower(*suffix) == 'f') {
 		result->type = T_FLOAT_END;
-	} else if (strcasecmp("l", suffix) == 0) {
+	} else if (suffix_len == 1 && g_ascii_tolower(*suffix) == 'l') {
 		result->type = T_LONGINTEGER;
 	} else {
-		_set_error(err, self, GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR, g_strdup_printf("Unexpected number suffix: \"%s\"", suffix));
+		_set_error(err, self, GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR, g_strdup_printf("Unexpected number suffix: \"%.*s\"", (int) suffix_len, suffix));
 		return false;
 	}
 
-	*suffix = '\0';
-
 	return true;
 }
 
-static bool _tokenize_identifier(GSDLTokenizer *self, GSDLToken *result, gunichar c, GError **err) {
-	int length = 7;
-	char *output = result->val = g_malloc(length);
-	GUnicodeType type;
-
-	int i = g_unichar_to_utf8(c, output);
+static bool _tokenize_identifier(GSDLTokenizer *self, GSDLToken *result, const char *start, GError **err) {
+	const char *p = self->pos;
 
-	while (_peek(self, &c, err) && (c == '-' || c == '.' || g_unichar_isalpha(c) || g_unichar_isdigit(c) || (type = g_unichar_type(c)) == G_UNICODE_CURRENCY_SYMBOL || type == G_UNICODE_CONNECT_PUNCTUATION || type == G_UNICODE_LETTER_NUMBER || type == G_UNICODE_SPACING_MARK || type == G_UNICODE_NON_SPACING_MARK)) {
-		GROW_IF_NEEDED(output = result->val, i + 5, length);
+	while (p < self->end) {
+		guchar b = *(const guchar*) p;
 
-		_consume(self);
-		i += g_unichar_to_utf8(c, output + i);
+		if (G_LIKELY(b < 0x80)) {
+			if (!_IS_ASCII_IDENTIFIER_CHAR(b)) break;
+			p++;
+		} else {
+			if (!_is_identifier_char(g_utf8_get_char(p))) break;
+			p += _CHAR_WIDTH(p);
+		}
 	}
 
-	FAIL_IF_ERR();
-	output[i] = '\0';
+	self->pos = p;
+	if (p == self->end && self->stream_open) self->starved = true;
+
+	result->val = start;
+	result->len = self->pos - start;
 
 	if (
-			strcmp(output, "true") == 0 ||
-			strcmp(output, "on") == 0 ||
-			strcmp(output, "false") == 0 ||
-			strcmp(output, "off") == 0) {
+			_slice_equal(result->val, result->len, "true") ||
+			_slice_equal(result->val, result->len, "on") ||
+			_slice_equal(result->val, result->len, "false") ||
+			_slice_equal(result->val, result->len, "off")) {
 		result->type = T_BOOLEAN;
-	} else if (strcmp(output, "null") == 0) {
+	} else if (_slice_equal(result->val, result->len, "null")) {
 		result->type = T_NULL;
 	}
 
 	return true;
 }
 
-static bool _tokenize_binary(GSDLTokenizer *self, GSDLToken *result, GError **err) {
-	int length = 7;
-	gunichar c;
-	char *output = result->val = g_malloc(length);
-	int i = 0;
+/*
+ * _take_output:
+ * @result: The token being tokenized.
+ * @output: (transfer full): The unescaped contents of @result.
+ *
+ * Points @result at a buffer that it owns, for the rare case where its contents had to be changed
+ * from what was in the input.
+ */
+static void _take_output(GSDLToken *result, GString *output) {
+	result->len = output->len;
+	result->val = result->_owned = g_string_free(output, FALSE);
+}
 
-	while (_peek(self, &c, err) && c != ']' && c != EOF) {
-		_consume(self);
+/*
+ * _decode_base64:
+ * @p: Start of the base64 data.
+ * @end: End of the base64 data.
+ * @out: Buffer for the decoded data, sized as for the decode_base64 kernel.
+ * @out_len: (out): Location to store the number of bytes decoded.
+ *
+ * Decodes base64, skipping over whitespace. Missing padding is tolerated.
+ *
+ * Returns: %NULL on success, or the position of the first character that made the input invalid.
+ */
+static const char* _decode_base64(const char *p, const char *end, guchar *out, gsize *out_len) {
+	guchar *o = out;
+	guint32 group = 0;
+	int group_len = 0;
+
+	while (p < end) {
+		if (group_len == 0) {
+			// Decode as much as possible in bulk, until the next bit of whitespace or padding.
+			gsize decoded = _scan.decode_base64(p, end, o);
+			p += decoded;
+			o += decoded / 4 * 3;
+
+			if (p == end) break;
+		}
 
-		if (c < 256 && (isalpha((char) c) || isdigit((char) c) || strchr("+/=", (char) c))) {
-			GROW_IF_NEEDED(output = result->val, i, length);
-			output[i++] = (gunichar) c;
+		guchar value = BASE64_VALUES[(guchar) *p];
+
+		if (value < 64) {
+			group = group << 6 | value;
+
+			if (++group_len == 4) {
+				*o++ = group >> 16;
+				*o++ = group >> 8;
+				*o++ = group;
+				group_len = 0;
+			}
+		} else if (*p == '=') {
+			break;
+		} else if (value != BASE64_SPACE) {
+			return p;
 		}
+
+		p++;
 	}
 
-	FAIL_IF_ERR();
-	output[i] = '\0';
+	// Up to two characters of padding and whitespace may follow the data.
+	for (int padding = 0; p < end; p++) {
+		if (*p == '=' ? ++padding > 2 : BASE64_VALUES[(guchar) *p] != BASE64_SPACE) return p;
+	}
+
+	switch (group_len) {
+		case 1:
+			// Only six bits, which isn't enough for a byte.
+			return end;
+		case 2:
+			*o++ = group >> 4;
+			break;
+		case 3:
+			*o++ = group >> 10;
+			*o++ = group >> 2;
+			break;
+	}
+
+	*out_len = o - out;
+	return NULL;
+}
+
+static bool _tokenize_binary(GSDLTokenizer *self, GSDLToken *result, GError **err) {
+	const char *start = self->pos, *close = memchr(start, ']', self->end - start);
+
+	if (!close) {
+		// The caller will report the missing ']'.
+		self->pos = self->end;
+
+		return true;
+	}
+
+	guchar *out = g_malloc((close - start) / 4 * 3 + 3 + 32);
+	gsize out_len;
+	const char *bad = _decode_base64(start, close, out, &out_len);
+
+	if (bad) {
+		g_free(out);
+		self->pos = bad;
+		_set_error(err, self, GSDL_SYNTAX_ERROR_BAD_LITERAL, bad == close ? "Truncated base64 in binary literal" : "Invalid base64 in binary literal");
+
+		return false;
+	}
+
+	self->pos = close;
+	result->val = result->_owned = (char*) out;
+	result->len = out_len;
 
 	return true;
 }
 
+/*
+ * _gsdl_tokenizer_steal_value:
+ * @self: A valid %GSDLTokenizer.
+ * @token: A token from the last call to gsdl_tokenizer_next_batch().
+ *
+ * Takes ownership of a token's value, if it was copied or decoded from the input.
+ *
+ * Returns: (transfer full): The value of @token, which must be freed with g_free(), or %NULL if it
+ *          points into the input.
+ */
+char* _gsdl_tokenizer_steal_value(GSDLTokenizer *self, GSDLToken *token) {
+	for (guint i = self->batch_owned->len; i-- > 0;) {
+		if (self->batch_owned->pdata[i] == token->val) {
+			self->batch_owned->pdata[i] = NULL;
+
+			return (char*) token->val;
+		}
+	}
+
+	return NULL;
+}
+
 static bool _tokenize_string(GSDLTokenizer *self, GSDLToken *result, GError **err) {
-	int length = 7;
-	gunichar c;
-	char *output = result->val = g_malloc(length);
-	int i = 0;
+	const char *start = self->pos, *p = _scan.find2(start, self->end, '"', '\\');
 
-	while (_peek(self, &c, err) && c != '"' && c != EOF) {
-		GROW_IF_NEEDED(output = result->val, i, length);
+	self->pos = p;
 
-		_consume(self);
+	if (p == self->end || *p == '"') {
+		// No escapes, so the contents can be used as-is.
+		result->val = start;
+		result->len = p - start;
 
-		if (c == '\\') {
-			_read(self, &c, err);
-
-			switch (c) {
-				case 'n': output[i++] = '\n'; break;
-				case 'r': output[i++] = '\r'; break;
-				case 't': output[i++] = '\t'; break;
-				case '"': output[i++] = '"'; break;
-				case '\'': output[i++] = '\"'; break;
-				case '\\': output[i++] = '\\'; break;
-				case '\r':
-					_read(self, &c, err);
-				case '\n':
-					output[i++] = '\n';
-					while (_peek(self, &c, err) && (c == ' ' || c == '\t')) _consume(self);
-					break;
-				default:
-					i += g_unichar_to_utf8(c, output + i);
-			}
-		} else {
-			i += g_unichar_to_utf8(c, output + i);
+		return true;
+	}
+
+	GString *output = g_string_new_len(start, p - start);
+	gunichar c;
+
+	while (self->pos < self->end && *self->pos == '\\') {
+		_consume(self);
+		if (!_read(self, &c, err) || c == EOF) break;
+
+		switch (c) {
+			case 'n': g_string_append_c(output, '\n'); break;
+			case 'r': g_string_append_c(output, '\r'); break;
+			case 't': g_string_append_c(output, '\t'); break;
+			case '"': g_string_append_c(output, '"'); break;
+			case '\'': g_string_append_c(output, '\"'); break;
+			case '\\': g_string_append_c(output, '\\'); break;
+			case '\r':
+				_read(self, &c, err);
+			case '\n':
+				g_string_append_c(output, '\n');
+				while (_peek(self, &c, err) && (c == ' ' || c == '\t')) _consume(self);
+				break;
+			default:
+				g_string_append_unichar(output, c);
 		}
+
+		// Copy everything up to the next escape or the end of the string in one go.
+		p = _scan.find2(self->pos, self->end, '"', '\\');
+		g_string_append_len(output, self->pos, p - self->pos);
+		self->pos = p;
 	}
 
+	_take_output(result, output);
 	FAIL_IF_ERR();
-	output[i] = '\0';
 
 	return true;
 }
 
 static bool _tokenize_backquote_string(GSDLTokenizer *self, GSDLToken *result, GError **err) {
-	int length = 7;
-	gunichar c;
-	char *output = result->val = g_malloc(length);
-	int i = 0;
+	const char *start = self->pos, *p = _scan.find2(start, self->end, '`', '\r');
+
+	self->pos = p;
 
-	while (_peek(self, &c, err) && c != '`' && c != EOF) {
-		GROW_IF_NEEDED(output = result->val, i, length);
+	if (p == self->end || *p == '`') {
+		result->val = start;
+		result->len = p - start;
+
+		return true;
+	}
+
+	GString *output = g_string_new_len(start, p - start);
+	gunichar c;
 
+	while (self->pos < self->end && *self->pos == '\r') {
 		_consume(self);
+		if (!_read(self, &c, err) || c == EOF) break;
 
-		if (c == '\r') _read(self, &c, err);
+		g_string_append_unichar(output, c);
 
-		i += g_unichar_to_utf8(c, output + i);
+		p = _scan.find2(self->pos, self->end, '`', '\r');
+		g_string_append_len(output, self->pos, p - self->pos);
+		self->pos = p;
 	}
 
+	_take_output(result, output);
 	FAIL_IF_ERR();
-	output[i] = '\0';
 
 	return true;
 }
 
-/**
- * gsdl_tokenizer_next:
+/*
+ * _skip_line_comment:
  * @self: A valid %GSDLTokenizer.
- * @result: (out callee-allocates): A %GSDLToken to initialize and fill in.
- * @err: (out) (allow-none): Location to store any error, may be %NULL.
  *
- * Fetches the next token from the input. Depending on the source of input, may set an error in one
- * of the %GSDL_SYNTAX_ERROR, %G_IO_CHANNEL_ERROR, or %G_CONVERT_ERROR domains.
+ * Moves to the end of the current line, leaving the newline to be tokenized.
+ */
+static void _skip_line_comment(GSDLTokenizer *self) {
+	const char *p = memchr(self->pos, '\n', self->end - self->pos);
+	self->pos = p ? p : self->end;
+}
+
+/*
+ * _skip_block_comment:
+ * @self: A valid %GSDLTokenizer, just past the start of a block comment.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Moves past the end of a block comment.
  *
- * Returns: Whether a token could be successfully read.
+ * Returns: Whether the comment was terminated.
  */
-bool gsdl_tokenizer_next(GSDLTokenizer *self, GSDLToken **result, GError **err) {
+static bool _skip_block_comment(GSDLTokenizer *self, GError **err) {
+	for (const char *p = self->pos;; p++) {
+		if (!(p = memchr(p, '*', self->end - p))) {
+			self->pos = self->end;
+			if (self->stream_open) {
+				self->starved = true;
+				return false;
+			}
+
+			_set_error(err,
+				self,
+				GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR,
+				"Unterminated comment"
+			);
+
+			return false;
+		} else if (p + 1 < self->end && p[1] == '/') {
+			self->pos = p + 2;
+
+			return true;
+		}
+	}
+}
+
+/*
+ * _finish_delimited:
+ * @self: A valid %GSDLTokenizer.
+ * @delim: The character that should close the token.
+ * @msg: Error message to set if it does not.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Reads the closing delimiter of a string, character or binary literal.
+ *
+ * Returns: Whether the delimiter was there.
+ */
+static bool _finish_delimited(GSDLTokenizer *self, gunichar delim, char *msg, GError **err) {
+	gunichar c;
+
+	REQUIRE(_read(self, &c, err));
+	if (c == delim) return true;
+
+	_set_error(err,
+		self,
+		GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
+		msg
+	);
+	return false;
+}
+
+static bool _next_token(GSDLTokenizer *self, GSDLToken *result, GError **err) {
 	gunichar c, nc;
-	int line;
-	int col;
+	const char *start;
+
+	result->_owned = NULL;
 
 	retry:
-	line = self->line;
-	col = self->col;
-	if (!_read(self, &c, err)) return false;
+	start = self->pos;
+
+	if (G_UNLIKELY(start >= self->end)) {
+		if (!_read(self, &c, err)) return false;
 
-	if (G_UNLIKELY(c == EOF)) {
-		*result = _maketoken(T_EOF, line, col);
+		_maketoken(self, result, T_EOF, start);
 		return true;
-	} else if (c == '\r') {
-		if (_peek(self, &c, err) && c == '\n') _consume(self);
+	}
 
-		*result = _maketoken('\n', line, col);
-		FAIL_IF_ERR();
+	// Everything but the first byte of a multi-byte character can be classified (and consumed)
+	// without decoding it.
+	c = *(const guchar*) start;
 
-		return true;
-	} else if ((c == '/' && _peek(self, &nc, err) && nc == '/') || (c == '-' && _peek(self, &nc, err) && nc == '-') || c == '#') {
-		if (c != '#') _consume(self);
-		while (_peek(self, &c, err) && !(c == '\n' || c == EOF)) _consume(self);
-
-		goto retry;
-	} else if (c == '/' && _peek(self, &nc, err) && nc == '*') {
-		while (_read(self, &c, err)) {
-			if (c == EOF) {
-				_set_error(err,
-					self,
-					GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR,
-					"Unterminated comment"
-				);
+	switch ((CharClass) CHAR_CLASSES[c]) {
+		case CLASS_BLANK:
+			do self->pos++; while (self->pos < self->end && (*self->pos == ' ' || *self->pos == '\t'));
 
-				return false;
-			} else if (c == '*' && _peek(self, &c, err) && c == '/') {
-				_consume(self);
-				break;
-			}
-		}
+			goto retry;
+
+		case CLASS_CR:
+			self->pos++;
+			if (_peek(self, &c, err) && c == '\n') _consume(self);
+
+			_maketoken(self, result, '\n', start);
+			FAIL_IF_ERR();
 
-		goto retry;
-	} else if (c < 256 && strchr("-+:;./{}=\n", (char) c)) {
-		*result = _maketoken(c, line, col);
-		return true;
-	} else if (c < 256 && isdigit((char) c)) {
-		*result = _maketoken(T_NUMBER, line, col);
-		return _tokenize_number(self, *result, c, err);
-	} else if (g_unichar_isalpha(c) || g_unichar_type(c) == G_UNICODE_CONNECT_PUNCTUATION || g_unichar_type(c) == G_UNICODE_CURRENCY_SYMBOL) {
-		*result = _maketoken(T_IDENTIFIER, line, col);
-		return _tokenize_identifier(self, *result, c, err);
-	} else if (c == '[') {
-		*result = _maketoken(T_BINARY, line, col);
-		if (!_tokenize_binary(self, *result, err)) return false;
-
-		REQUIRE(_read(self, &c, err));
-		if (c == ']') {
 			return true;
-		} else {
-			_set_error(err,
-				self,
-				GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
-				"Missing ']'"
-			);
-			return false;
-		}
-	} else if (c == '"') {
-		*result = _maketoken(T_STRING, line, col);
-		if (!_tokenize_string(self, *result, err)) return false;
 
-		REQUIRE(_read(self, &c, err));
-		if (c == '"') {
+		case CLASS_PUNCT:
+			self->pos++;
+			_maketoken(self, result, c, start);
+
 			return true;
-		} else {
-			_set_error(err,
-				self,
-				GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
-				"Missing '\"'"
-			);
-			return false;
-		}
-	} else if (c == '`') {
-		*result = _maketoken(T_STRING, line, col);
-		if (!_tokenize_backquote_string(self, *result, err)) return false;
 
-		REQUIRE(_read(self, &c, err));
-		if (c == '`') {
+		case CLASS_SLASH:
+			self->pos++;
+			if (_peek(self, &nc, err) && nc == '/') {
+				_skip_line_comment(self);
+
+				goto retry;
+			} else if (nc == '*') {
+				REQUIRE(_skip_block_comment(self, err));
+
+				goto retry;
+			}
+
+			_maketoken(self, result, c, start);
 			return true;
-		} else {
-			_set_error(err,
-				self,
-				GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
-				"Missing '`'"
-			);
-			return false;
-		}
-	} else if (c == '\'') {
-		*result = _maketoken(T_CHAR, line, col);
-		(*result)->val = g_malloc0(4);
-
-		_read(self, &c, err);
-
-		if (c == '\\') {
-			_read(self, &c, err);
-
-			switch (c) {
-				case 'n': c = '\n'; break;
-				case 'r': c = '\r'; break;
-				case 't': c = '\t'; break;
-				case '"': c = '"'; break;
-				case '\'': c = '\''; break;
-				case '\\': c = '\\'; break;
+
+		case CLASS_DASH:
+			self->pos++;
+			if (_peek(self, &nc, err) && nc == '-') {
+				_skip_line_comment(self);
+
+				goto retry;
+			}
+
+			_maketoken(self, result, c, start);
+			return true;
+
+		case CLASS_HASH:
+			self->pos++;
+			_skip_line_comment(self);
+
+			goto retry;
+
+		case CLASS_BACKSLASH:
+			self->pos++;
+			if (!_peek(self, &nc, err) || (nc != '\r' && nc != '\n')) break;
+
+			_consume(self);
+			if (nc == '\r' && _peek(self, &nc, err) && nc == '\n') _consume(self);
+
+			goto retry;
+
+		case CLASS_DIGIT:
+			self->pos++;
+			_maketoken(self, result, T_NUMBER, start);
+
+			return _tokenize_number(self, result, err);
+
+		case CLASS_IDENTIFIER:
+			self->pos++;
+			_maketoken(self, result, T_IDENTIFIER, start);
+
+			return _tokenize_identifier(self, result, start, err);
+
+		case CLASS_BINARY:
+			self->pos++;
+			_maketoken(self, result, T_BINARY, start);
+			if (!_tokenize_binary(self, result, err)) return false;
+
+			return _finish_delimited(self, ']', "Missing ']'", err);
+
+		case CLASS_STRING:
+			self->pos++;
+			_maketoken(self, result, T_STRING, start);
+			if (!_tokenize_string(self, result, err)) return false;
+
+			return _finish_delimited(self, '"', "Missing '\"'", err);
+
+		case CLASS_BACKQUOTE_STRING:
+			self->pos++;
+			_maketoken(self, result, T_STRING, start);
+			if (!_tokenize_backquote_string(self, result, err)) return false;
+
+			return _finish_delimited(self, '`', "Missing '`'", err);
+
+		case CLASS_CHAR:
+			self->pos++;
+			_maketoken(self, result, T_CHAR, start);
+
+			result->val = self->pos;
+			REQUIRE(_read(self, &c, err));
+
+			if (c == '\\') {
+				result->val = self->pos;
+				REQUIRE(_read(self, &c, err));
+
+				switch (c) {
+					case 'n': result->val = "\n"; break;
+					case 'r': result->val = "\r"; break;
+					case 't': result->val = "\t"; break;
+				}
 			}
+
+			result->len = c == EOF ? 0 : _CHAR_WIDTH(result->val);
+
+			return _finish_delimited(self, '\'', "Missing \"'\"", err);
+
+		case CLASS_UNICODE:
+			REQUIRE(_read(self, &c, err));
+
+			if (g_unichar_isalpha(c) || g_unichar_type(c) == G_UNICODE_CONNECT_PUNCTUATION || g_unichar_type(c) == G_UNICODE_CURRENCY_SYMBOL) {
+				_maketoken(self, result, T_IDENTIFIER, start);
+
+				return _tokenize_identifier(self, result, start, err);
+			}
+
+			break;
+
+		case CLASS_INVALID:
+			self->pos++;
+			break;
+	}
+
+	c = _decode(start);
+	_set_error(err,
+		self,
+		GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR,
+		g_strdup_printf("Invalid character '%s'(%d)", g_ucs4_to_utf8(&c, 1, NULL, NULL, NULL), c)
+	);
+	return false;
+}
+
+/*
+ * _next:
+ * @self: A valid %GSDLTokenizer.
+ * @result: (out caller-allocates): A %GSDLToken to fill in.
+ * @err: (out) (allow-none): Location to store any error, may be %NULL.
+ *
+ * Does the actual work of gsdl_tokenizer_next() and gsdl_tokenizer_next_batch().
+ *
+ * If a push-mode tokenizer runs out of input partway through a token, whatever was read of it is
+ * backed out of, so it can be read again from the start once more input arrives.
+ *
+ * Returns: Whether a token could be successfully read. Fails without setting an error if more input
+ *          is needed.
+ */
+static bool _next(GSDLTokenizer *self, GSDLToken *result, GError **err) {
+	const char *start = self->pos;
+
+	self->starved = false;
+
+	bool success = _next_token(self, result, err);
+
+	if (G_UNLIKELY(self->starved)) {
+		// Any error was caused by the token being cut off, and will go away once the rest of it arrives.
+		if (err) g_clear_error(err);
+		g_free(result->_owned);
+		result->_owned = NULL;
+
+		self->pos = start;
+
+		return false;
+	}
+
+	return success;
+}
+
+/*
+ * _gsdl_tokenizer_get_position:
+ * @self: A valid %GSDLTokenizer.
+ *
+ * Used by the parser to back up to the start of a partially read tag in push mode.
+ *
+ * Returns: The offset of the next token to be read.
+ */
+gsize _gsdl_tokenizer_get_position(GSDLTokenizer *self) {
+	return self->stream_offset + (self->pos - self->buf);
+}
+
+/*
+ * _gsdl_tokenizer_set_position:
+ * @self: A valid %GSDLTokenizer.
+ * @offset: An offset returned by _gsdl_tokenizer_get_position(), or inside a token that has been
+ *          read, after the last call to gsdl_tokenizer_feed().
+ *
+ * Moves the tokenizer back to a position it has already been at.
+ */
+void _gsdl_tokenizer_set_position(GSDLTokenizer *self, gsize offset) {
+	g_assert(offset >= self->stream_offset && _AT(self, offset) <= self->end);
+
+	self->pos = _AT(self, offset);
+	self->buf_done = false;
+}
+
+/*
+ * _gsdl_tokenizer_skip:
+ * @self: A valid %GSDLTokenizer.
+ * @depth: (inout): Number of blocks the tokenizer is inside of. Decremented for every block that is
+ *         left, and incremented for every block that is entered.
+ * @err: (out) (allow-none): Location to store any %GError, or %NULL.
+ *
+ * Moves past the end of the current block (or blocks), without tokenizing anything inside. Only
+ * braces, strings, character and binary literals and comments are recognized, so nothing but the
+ * nesting of the braces is checked.
+ *
+ * If @depth is 0, instead moves up to the end of the current tag's values and attributes; that is,
+ * to the next newline ('\n' or '\r'), ';', '{' or '}' that is not part of a literal or comment, or to
+ * the end of the input.
+ *
+ * If a push-mode tokenizer runs out of input, it stops at the start of whatever it was in the middle
+ * of, and @depth is left at the depth there, so the skip can be picked up where it left off.
+ *
+ * Returns: Whether the end of the outermost block (or the tag's values) was found. Fails without
+ *          setting an error if more input is needed.
+ */
+bool _gsdl_tokenizer_skip(GSDLTokenizer *self, guint *depth, GError **err) {
+	const char *p = self->pos, *end = self->end, *found;
+
+	while (p < end) {
+		// Start of the current lexeme; where to resume from if it is cut off.
+		const char *start = p;
+		guchar c = *(const guchar*) p++;
+
+		switch ((CharClass) CHAR_CLASSES[c]) {
+			case CLASS_PUNCT:
+			case CLASS_INVALID:
+				if (*depth == 0 && (c == '\n' || c == ';' || c == '{' || c == '}')) {
+					self->pos = start;
+
+					return true;
+				} else if (c == '{') {
+					(*depth)++;
+				} else if (c == '}' && --*depth == 0) {
+					self->pos = p;
+
+					return true;
+				}
+
+				continue;
+
+			case CLASS_CR:
+				// A lone '\r' ends a line just as '\n' does.
+				if (*depth == 0) {
+					self->pos = start;
+
+					return true;
+				}
+
+				continue;
+
+			case CLASS_SLASH:
+				if (p == end) goto cut_off;
+
+				if (*p == '*') {
+					for (found = p + 1; (found = memchr(found, '*', end - found)) && (found + 1 >= end || found[1] != '/'); found++);
+					if (!found || found + 1 >= end) goto cut_off;
+
+					p = found + 2;
+					continue;
+				} else if (*p != '/') {
+					continue;
+				}
+
+				goto line_comment;
+
+			case CLASS_DASH:
+				if (p == end) goto cut_off;
+				if (*p != '-') continue;
+
+				goto line_comment;
+
+			case CLASS_HASH:
+			line_comment:
+				if (!(found = memchr(p, '\n', end - p))) goto cut_off;
+
+				p = found;
+				continue;
+
+			case CLASS_STRING:
+				for (found = p; (found = _scan.find2(found, end, '"', '\\')) < end && *found == '\\'; found += 2);
+				if (found >= end) goto cut_off;
+
+				p = found + 1;
+				continue;
+
+			case CLASS_BACKQUOTE_STRING:
+				if (!(found = memchr(p, '`', end - p))) goto cut_off;
+
+				p = found + 1;
+				continue;
+
+			case CLASS_BINARY:
+				if (!(found = memchr(p, ']', end - p))) goto cut_off;
+
+				p = found + 1;
+				continue;
+
+			case CLASS_CHAR:
+				if (p < end && *p == '\\') p++;
+				if (p >= end) goto cut_off;
+				p += _CHAR_WIDTH(p);
+				if (p >= end) goto cut_off;
+				if (*p == '\'') p++;
+
+				continue;
+
+			case CLASS_BACKSLASH:
+				// A line continuation, which does not end a tag's values.
+				if (p < end && *p == '\r') p++;
+				if (p == end) goto cut_off;
+				if (*p == '\n') p++;
+
+				continue;
+
+			case CLASS_DIGIT:
+				// Words are skipped whole, so that a "--" inside one is not taken for a comment. One that
+				// runs up to the end of the input may not be whole yet.
+				while (p < end && g_ascii_isalnum(*p)) p++;
+				if (p == end && self->stream_open) goto cut_off;
+
+				continue;
+
+			case CLASS_IDENTIFIER:
+			case CLASS_UNICODE:
+				while (p < end && (*(const guchar*) p >= 0x80 || _IS_ASCII_IDENTIFIER_CHAR(*(const guchar*) p))) p++;
+				if (p == end && self->stream_open) goto cut_off;
+
+				continue;
+
+			default:
+				continue;
 		}
 
-		g_unichar_to_utf8(c, (*result)->val); 
+		cut_off:
+		p = start;
+		break;
+	}
 
-		REQUIRE(_read(self, &c, err));
-		if (c == '\'') {
-			return true;
-		} else {
-			_set_error(err,
-				self,
-				GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
-				"Missing \"'\""
-			);
+	self->pos = p;
+
+	if (self->stream_open) return false;
+
+	// Anything cut off at the end of a tag's values is left for the tokenizer to report.
+	if (*depth == 0) return true;
+
+	self->pos = end;
+	_set_error(err,
+		self,
+		GSDL_SYNTAX_ERROR_MISSING_DELIMITER,
+		"Missing '}'"
+	);
+
+	return false;
+}
+
+/**
+ * gsdl_tokenizer_next:
+ * @self: A valid %GSDLTokenizer.
+ * @result: (out callee-allocates): A %GSDLToken to initialize and fill in.
+ * @err: (out) (allow-none): Location to store any error, may be %NULL.
+ *
+ * Fetches the next token from the input. Depending on the source of input, may set an error in one
+ * of the %GSDL_SYNTAX_ERROR, %G_IO_CHANNEL_ERROR, or %G_CONVERT_ERROR domains.
+ *
+ * Returns: Whether a token could be successfully read. A push-mode tokenizer that needs more input
+ *          returns %FALSE without setting an error.
+ */
+bool gsdl_tokenizer_next(GSDLTokenizer *self, GSDLToken **result, GError **err) {
+	*result = g_slice_new(GSDLToken);
+
+	if (!_next(self, *result, err)) {
+		gsdl_token_free(*result);
+		*result = NULL;
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * gsdl_tokenizer_next_batch:
+ * @self: A valid %GSDLTokenizer.
+ * @out: (out caller-allocates) (array length=max): An array of tokens to fill in.
+ * @max: The number of tokens that fit in @out.
+ * @n: (out): Location to store the number of tokens filled in.
+ * @err: (out) (allow-none): Location to store any error, may be %NULL.
+ *
+ * Fetches up to @max tokens at once, stopping early after %T_EOF. Unlike gsdl_tokenizer_next(),
+ * the tokens must not be passed to gsdl_token_free(); any values that had to be copied are owned by
+ * the tokenizer, and stay valid until the next call to gsdl_tokenizer_next_batch().
+ *
+ * If an error occurs, or a push-mode tokenizer needs more input, the tokens read before that are
+ * still filled in and counted in @n.
+ *
+ * Returns: Whether all of the tokens could be successfully read.
+ */
+bool gsdl_tokenizer_next_batch(GSDLTokenizer *self, GSDLToken *out, gsize max, gsize *n, GError **err) {
+	g_ptr_array_set_size(self->batch_owned, 0);
+
+	for (*n = 0; *n < max; ) {
+		GSDLToken *token = &out[*n];
+
+		if (!_next(self, token, err)) {
+			g_free(token->_owned);
 			return false;
 		}
-	} else if (c == '\\' && _peek(self, &nc, err) && (nc == '\r' || nc == '\n')) {
-		_consume(self);
 
-		if (c == '\r') _read(self, &c, err);
+		if (token->_owned) {
+			g_ptr_array_add(self->batch_owned, token->_owned);
+			token->_owned = NULL;
+		}
 
-		goto retry;
-	} else if (c == ' ' || c == '\t') {
-		// Do nothing
-		goto retry;
-	} else {
-		_set_error(err,
-			self,
-			GSDL_SYNTAX_ERROR_UNEXPECTED_CHAR,
-		   	g_strdup_printf("Invalid character '%s'(%d)", g_ucs4_to_utf8(&c, 1, NULL, NULL, NULL), c)
-		);
-		return false;
+		(*n)++;
+
+		if (token->type == T_EOF) break;
 	}
+
+	return true;
 }
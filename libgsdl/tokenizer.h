@@ -66,18 +66,30 @@ typedef enum {
  * GSDLToken:
  * @type: The type of the token, either one of %GSDLTokenType or an ASCII character in the range
  *        0-255.
- * @line: The line where the token occurred.
- * @col: The column where the token occurred.
- * @val: Any string contents of the token, as a %NULL-terminated string. This is undefined for any
- *       single-character token, and %T_EOF and %T_NULL.
+ * @offset: The offset of the start of the token in the input, in bytes. Pass this to
+ *          gsdl_tokenizer_get_location() to find its line and column.
+ * @val: Any string contents of the token. This is undefined for any single-character token, and
+ *       %T_EOF and %T_NULL. It is <emphasis>not</emphasis> %NULL-terminated; it usually points
+ *       directly into the input, and is only copied when unescaping changed its contents. Either way,
+ *       it stays valid until both the token and its %GSDLTokenizer are freed, or, for a push-mode
+ *       tokenizer, until more input is fed to it. For %T_BINARY, this holds the decoded data.
+ * @len: The length of @val, in bytes.
+ * @num: For the numeric tokens (%T_NUMBER, %T_LONGINTEGER, %T_DATE_PART, %T_TIME_PART, %T_DAYS and
+ *       the %T_FLOAT_END family), the value of the token's digits, or %G_MAXUINT64 if they do not
+ *       fit. The number of digits, including leading zeroes, is @len.
  */
 typedef struct {
 	GSDLTokenType type;
 
-	guint line;
-	guint col;
+	gsize offset;
 
-	char *val;
+	const char *val;
+	gsize len;
+
+	guint64 num;
+
+	/*< private >*/
+	char *_owned;
 } GSDLToken;
 
 typedef struct _GSDLTokenizer GSDLTokenizer;
@@ -85,9 +97,15 @@ typedef struct _GSDLTokenizer GSDLTokenizer;
 //> Exported Functions
 extern GSDLTokenizer* gsdl_tokenizer_new(const char *filename, GError **err);
 extern GSDLTokenizer* gsdl_tokenizer_new_from_string(const char *str, GError **err);
+extern GSDLTokenizer* gsdl_tokenizer_new_push();
+
+extern bool gsdl_tokenizer_feed(GSDLTokenizer *self, const char *buf, gsize len, GError **err);
+extern bool gsdl_tokenizer_end(GSDLTokenizer *self, GError **err);
 
 extern bool gsdl_tokenizer_next(GSDLTokenizer *self, GSDLToken **token, GError **err);
+extern bool gsdl_tokenizer_next_batch(GSDLTokenizer *self, GSDLToken *out, gsize max, gsize *n, GError **err);
 extern char* gsdl_tokenizer_get_filename(GSDLTokenizer *self);
+extern void gsdl_tokenizer_get_location(GSDLTokenizer *self, gsize offset, guint *line, guint *col);
 
 extern void gsdl_tokenizer_free(GSDLTokenizer *self);
 
@@ -0,0 +1,68 @@
+// Callbacks and helpers shared by the tests, which all describe tags in the same format:
+// "(name,type:value,attr=type:value\n" when a tag starts, and "name)\n" when it ends. Each test is
+// its own program, so this is included by exactly one source file in each.
+
+#ifndef __TEST_APPENDERS_H__
+#define __TEST_APPENDERS_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <parser.h>
+
+// Appends ",type:value", or ",attr=type:value" if attr_name is set.
+void append_gvalue(GString *result, const gchar *attr_name, const GValue *value) {
+	char *contents = g_strdup_value_contents(value);
+
+	g_string_append_c(result, ',');
+	if (attr_name) {
+		g_string_append(result, attr_name);
+		g_string_append_c(result, '=');
+	}
+	g_string_append(result, G_VALUE_TYPE_NAME(value));
+	g_string_append_c(result, ':');
+	g_string_append(result, contents);
+
+	g_free(contents);
+}
+
+void start_tag_block_appender(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GValue *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GValue *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GString *result = (GString*) user_data;
+
+	g_string_append_c(result, '(');
+	g_string_append(result, name);
+
+	for (guint i = 0; i < n_values; i++) append_gvalue(result, NULL, &values[i]);
+	for (guint i = 0; i < n_attrs; i++) append_gvalue(result, attr_names[i], &attr_values[i]);
+
+	g_assert(attr_names[n_attrs] == NULL);
+	g_string_append_c(result, '\n');
+}
+
+void end_tag_appender(
+		GSDLParserContext *context,
+		const char *name,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GString *result = (GString*) user_data;
+
+	g_string_append(result, name);
+	g_string_append(result, ")\n");
+}
+
+// Checks a newly-allocated description against what was expected, then frees it.
+#define ASSERT_REPR(repr_expr, expected) do { char *repr = (repr_expr); g_assert_cmpstr(repr, ==, expected); g_free(repr); } while(0)
+
+#endif
@@ -0,0 +1,201 @@
+#include <document.h>
+#include <glib.h>
+#include <parser.h>
+#include <string.h>
+#include <syntax.h>
+#include <unistd.h>
+
+#include "appenders.h"
+
+// Appends a document value as append_gvalue() does.
+void append_doc_value(GString *result, const gchar *attr_name, const GSDLDocValue *value) {
+	GValue gvalue = G_VALUE_INIT;
+
+	gsdl_doc_value_to_gvalue(value, &gvalue);
+	append_gvalue(result, attr_name, &gvalue);
+	g_value_unset(&gvalue);
+}
+
+// Builds the same representation as the parser tests' appender, from a whole document.
+void append_node(GString *result, const GSDLDocument *document, guint node) {
+	g_string_append_c(result, '(');
+	g_string_append(result, gsdl_document_get_name(document, node));
+
+	for (guint i = 0; i < gsdl_document_get_n_values(document, node); i++) {
+		append_doc_value(result, NULL, gsdl_document_get_value(document, node, i));
+	}
+
+	for (guint i = 0; i < gsdl_document_get_n_attrs(document, node); i++) {
+		append_doc_value(result, gsdl_document_get_attr_name(document, node, i), gsdl_document_get_attr_value(document, node, i));
+	}
+
+	g_string_append_c(result, '\n');
+
+	for (guint child = gsdl_document_get_first_child(document, node); child; child = gsdl_document_get_next_sibling(document, child)) {
+		append_node(result, document, child);
+	}
+
+	g_string_append(result, gsdl_document_get_name(document, node));
+	g_string_append(result, ")\n");
+}
+
+GString* document_repr(const GSDLDocument *document) {
+	GString *result = g_string_new("");
+
+	for (guint child = gsdl_document_get_first_child(document, 0); child; child = gsdl_document_get_next_sibling(document, child)) {
+		append_node(result, document, child);
+	}
+
+	return result;
+}
+
+void test_document_navigation() {
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string("a {\n\tb\n\tc {\n\t\td\n\t}\n\te\n}\nf", &error);
+
+	g_assert_no_error(error);
+	g_assert(document != NULL);
+	g_assert_cmpint(gsdl_document_get_n_nodes(document), ==, 7);
+	g_assert_cmpstr(gsdl_document_get_name(document, 0), ==, "");
+
+	// Nodes are numbered in document order.
+	const char *names[] = { "", "a", "b", "c", "d", "e", "f" };
+	for (guint i = 0; i < 7; i++) g_assert_cmpstr(gsdl_document_get_name(document, i), ==, names[i]);
+
+	g_assert_cmpint(gsdl_document_get_first_child(document, 0), ==, 1);
+	g_assert_cmpint(gsdl_document_get_next_sibling(document, 1), ==, 6);
+	g_assert_cmpint(gsdl_document_get_next_sibling(document, 6), ==, 0);
+	g_assert_cmpint(gsdl_document_get_first_child(document, 1), ==, 2);
+	g_assert_cmpint(gsdl_document_get_next_sibling(document, 2), ==, 3);
+	g_assert_cmpint(gsdl_document_get_next_sibling(document, 3), ==, 5);
+	g_assert_cmpint(gsdl_document_get_first_child(document, 3), ==, 4);
+	g_assert_cmpint(gsdl_document_get_first_child(document, 4), ==, 0);
+	g_assert_cmpint(gsdl_document_get_first_child(document, 6), ==, 0);
+
+	gsdl_document_free(document);
+
+	document = gsdl_document_new_from_string("", &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(gsdl_document_get_n_nodes(document), ==, 1);
+	g_assert_cmpint(gsdl_document_get_first_child(document, 0), ==, 0);
+	gsdl_document_free(document);
+}
+
+void test_document_values() {
+	const char *input = "tag 1 -32L 52.3 25.3f -8923.33bd true false null \"abc\" `raw` '\xe2\x80\x93' [ZW1iZWRkZWQAbnVsbHM=]\n"
+		"dates -50d:32:23:21 20:42:32.324 2042/4/20 2012/2/5 5:30 2001/02/23 4:00:23.52 502/10/10 12:00:00-GMT+4:15 1924/11/4 19:34:5\n"
+		"outer int=58 str=\"\" bin=[] {\n\tinner 2 nil=null\n}";
+	GString *expected = g_string_new("");
+	GSDLParser parser = { NULL, end_tag_appender, NULL, start_tag_block_appender };
+	GSDLParserContext *context = gsdl_parser_context_new(&parser, (gpointer) expected);
+
+	g_assert(gsdl_parser_context_parse_string(context, input));
+	gsdl_parser_context_free(context);
+
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string(input, &error);
+	g_assert_no_error(error);
+
+	// Every value should come back out as the same GValue the parser produced.
+	GString *result = document_repr(document);
+	g_assert_cmpstr(result->str, ==, expected->str);
+
+	const GSDLDocValue *value = gsdl_document_get_value(document, 1, 8);
+	g_assert_cmpint(value->type, ==, GSDL_DOC_STRING);
+	g_assert_cmpint(value->len, ==, 3);
+	g_assert_cmpstr(value->v_str, ==, "abc");
+
+	value = gsdl_document_get_value(document, 1, 11);
+	g_assert_cmpint(value->type, ==, GSDL_DOC_BINARY);
+	g_assert_cmpint(value->len, ==, 14);
+	g_assert(memcmp(value->v_str, "embedded\0nulls", 14) == 0);
+
+	value = gsdl_document_get_value(document, 2, 5);
+	g_assert_cmpint(value->type, ==, GSDL_DOC_DATETIME);
+	g_assert_cmpint(value->utc_offset, ==, 4 * 3600 + 15 * 60);
+
+	g_string_free(result, TRUE);
+	g_string_free(expected, TRUE);
+	gsdl_document_free(document);
+}
+
+void test_document_attrs() {
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string("node name=\"a\" port=80\nnode port=81 weight=2.5\nport", &error);
+
+	g_assert_no_error(error);
+
+	g_assert_cmpint(gsdl_document_get_n_attrs(document, 1), ==, 2);
+	g_assert_cmpstr(gsdl_document_get_attr_name(document, 1, 0), ==, "name");
+	g_assert_cmpstr(gsdl_document_get_attr_value(document, 1, 0)->v_str, ==, "a");
+
+	g_assert_cmpint(gsdl_document_find_attr(document, 1, "port")->v_int, ==, 80);
+	g_assert_cmpint(gsdl_document_find_attr(document, 2, "port")->v_int, ==, 81);
+	g_assert(gsdl_document_find_attr(document, 2, "name") == NULL);
+	g_assert(gsdl_document_find_attr(document, 1, "missing") == NULL);
+	g_assert(gsdl_document_find_attr(document, 3, "port") == NULL);
+
+	// Names are shared between tags and attributes.
+	guint node_id = gsdl_document_lookup_name(document, "node"), port_id = gsdl_document_lookup_name(document, "port");
+	g_assert_cmpint(node_id, !=, 0);
+	g_assert_cmpint(port_id, !=, 0);
+	g_assert_cmpint(node_id, !=, port_id);
+	g_assert_cmpint(gsdl_document_get_name_id(document, 1), ==, node_id);
+	g_assert_cmpint(gsdl_document_get_name_id(document, 2), ==, node_id);
+	g_assert_cmpint(gsdl_document_get_name_id(document, 3), ==, port_id);
+	g_assert_cmpstr(gsdl_document_name_from_id(document, port_id), ==, "port");
+	g_assert_cmpint(gsdl_document_lookup_name(document, "weight"), !=, 0);
+	g_assert_cmpint(gsdl_document_lookup_name(document, "missing"), ==, 0);
+
+	gsdl_document_free(document);
+}
+
+void test_document_error() {
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string("a {\n\tb 1\n\tc \"unterminated", &error);
+
+	g_assert(document == NULL);
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_MISSING_DELIMITER);
+	g_clear_error(&error);
+
+	document = gsdl_document_new_from_file("/nonexistent/file.sdl", &error);
+	g_assert(document == NULL);
+	g_assert(error != NULL);
+	g_error_free(error);
+}
+
+void test_document_file() {
+	char *filename;
+	GIOChannel *channel = g_io_channel_unix_new(g_file_open_tmp("test-document.XXXXXX", &filename, NULL));
+	g_io_channel_write_chars(channel, "server host=\"localhost\" {\n\tlistener 80\n\tlistener 443 tls=true\n}\n", -1, NULL, NULL);
+	g_io_channel_shutdown(channel, true, NULL);
+	g_io_channel_unref(channel);
+
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_file(filename, &error);
+
+	g_assert_no_error(error);
+
+	GString *result = document_repr(document);
+	g_assert_cmpstr(result->str, ==, "(server,host=gchararray:\"localhost\"\n(listener,gint:80\nlistener)\n(listener,gint:443,tls=gboolean:TRUE\nlistener)\nserver)\n");
+
+	g_string_free(result, TRUE);
+	gsdl_document_free(document);
+	unlink(filename);
+	g_free(filename);
+}
+
+#define TEST(name) g_test_add_func("/document/"#name, test_document_##name)
+
+int main(int argc, char **argv) {
+	g_type_init();
+	g_test_init(&argc, &argv, NULL);
+
+	TEST(navigation);
+	TEST(values);
+	TEST(attrs);
+	TEST(error);
+	TEST(file);
+
+	return g_test_run();
+}
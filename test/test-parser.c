@@ -1,8 +1,11 @@
 #include <glib.h>
 #include <parser.h>
+#include <string.h>
 #include <syntax.h>
 #include <unistd.h>
 
+#include "appenders.h"
+
 void start_tag_appender(
 		GSDLParserContext *context,
 		const gchar *name,
@@ -14,66 +17,86 @@ void start_tag_appender(
 	) {
 
 	GString *result = (GString*) user_data;
-	GString *repr = g_string_new("(");
 
-	g_string_append(repr, name);
+	g_string_append_c(result, '(');
+	g_string_append(result, name);
 
-	for (; *values; values++) {
-		g_string_append_c(repr, ',');
-		g_string_append(repr, G_VALUE_TYPE_NAME(*values));
-		g_string_append_c(repr, ':');
-		g_string_append(repr, g_strdup_value_contents(*values));
-	}
+	for (; *values; values++) append_gvalue(result, NULL, *values);
+	for (; *attr_names; attr_names++, attr_values++) append_gvalue(result, *attr_names, *attr_values);
 
-	for (; *attr_names; attr_names++, attr_values++) {
-		g_string_append_c(repr, ',');
-		g_string_append(repr, *attr_names);
-		g_string_append_c(repr, '=');
-		g_string_append(repr, G_VALUE_TYPE_NAME(*attr_values));
-		g_string_append_c(repr, ':');
-		g_string_append(repr, g_strdup_value_contents(*attr_values));
-	}
+	g_string_append_c(result, '\n');
+}
+
+void error_appender(
+		GSDLParserContext *context,
+		GError *err,
+		gpointer user_data
+	) {
 
-	g_string_append_c(repr, '\n');
+	GString *result = (GString*) user_data;
 
-	g_string_append(result, repr->str);
+	g_string_append(result, "E: ");
+	g_string_append(result, err->message);
 }
 
+GSDLParser appender_parser = {
+	start_tag_appender,
+	end_tag_appender,
+	error_appender
+};
+
+GSDLParser block_appender_parser = {
+	NULL,
+	end_tag_appender,
+	error_appender,
+	start_tag_block_appender
+};
 
-void end_tag_appender(
+void start_tag_lazy_appender(
 		GSDLParserContext *context,
-		const char *name,
+		const gchar *name,
+		const GSDLValueRef *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GSDLValueRef *attr_values,
+		guint n_attrs,
 		gpointer user_data,
 		GError **err
 	) {
 
-	GString *result = (GString*) user_data;
-	GString *repr = g_string_new("");
+	// Values first, then attributes; one extra so the array is never empty.
+	GValue storage[n_values + n_attrs + 1];
+	GValue *decoded[n_values + 1], *attr_decoded[n_attrs + 1];
 
-	g_string_append(repr, name);
+	memset(storage, 0, sizeof(storage));
 
-	g_string_append(repr, ")\n");
+	for (guint i = 0; i < n_values + n_attrs; i++) {
+		const GSDLValueRef *ref = i < n_values ? &values[i] : &attr_values[i - n_values];
 
-	g_string_append(result, repr->str);
-}
+		if (!gsdl_parser_context_decode(context, ref, &storage[i], err)) goto done;
+		g_assert(G_VALUE_HOLDS(&storage[i], ref->type));
+	}
 
+	for (guint i = 0; i < n_values; i++) decoded[i] = &storage[i];
+	decoded[n_values] = NULL;
 
-void error_appender(
-		GSDLParserContext *context,
-		GError *err,
-		gpointer user_data
-	) {
+	for (guint i = 0; i < n_attrs; i++) attr_decoded[i] = &storage[n_values + i];
+	attr_decoded[n_attrs] = NULL;
 
-	GString *result = (GString*) user_data;
+	start_tag_appender(context, name, decoded, attr_names, attr_decoded, user_data, err);
 
-	g_string_append(result, "E: ");
-	g_string_append(result, err->message);
+	done:
+	for (guint i = 0; i < n_values + n_attrs; i++) {
+		if (G_IS_VALUE(&storage[i])) g_value_unset(&storage[i]);
+	}
 }
 
-GSDLParser appender_parser = {
-	start_tag_appender,
+GSDLParser lazy_appender_parser = {
+	NULL,
 	end_tag_appender,
-	error_appender
+	error_appender,
+	NULL,
+	start_tag_lazy_appender
 };
 
 //> Actual Tests
@@ -127,6 +150,61 @@ void test_parser_value_numbers() {
 	g_assert(success);
 }
 
+static void _start_tag_numbers(
+		GSDLParserContext *context,
+		const gchar *name,
+		GValue* const *values,
+		gchar* const *attr_names,
+		GValue* const *attr_values,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GArray *result = (GArray*) user_data;
+
+	for (guint i = 0; values[i]; i++) {
+		double number = G_VALUE_HOLDS_FLOAT(values[i]) ? g_value_get_float(values[i]) : g_value_get_double(values[i]);
+		g_array_append_val(result, number);
+	}
+}
+
+void test_parser_value_numbers_exact() {
+	GSDLParser numbers_parser = { _start_tag_numbers, NULL, NULL };
+	GArray *result = g_array_new(FALSE, FALSE, sizeof(double));
+	GSDLParserContext *context = gsdl_parser_context_new(&numbers_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_parse_string(context,
+		"tag 0.000000000000000000000000123 0.000000000000000000000000123f "
+		// Exactly halfway between 1 and the next float, which rounds to even.
+		"1.000000059604644775390625f "
+		// Just past halfway; rounding to a double first would land exactly halfway, then on 1.
+		"1.00000005960464477539062501f"
+	));
+	g_assert_cmpuint(result->len, ==, 4);
+	g_assert_cmpfloat(g_array_index(result, double, 0), ==, 1.23e-25);
+	g_assert_cmpfloat(g_array_index(result, double, 1), ==, 1.23e-25f);
+	g_assert_cmpfloat(g_array_index(result, double, 2), ==, 1.0f);
+	g_assert_cmpfloat(g_array_index(result, double, 3), ==, 1.00000011920928955078125f);
+
+	gsdl_parser_context_free(context);
+	g_array_free(result, TRUE);
+}
+
+void test_parser_value_numbers_range() {
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+	g_assert(context != NULL);
+	bool success = gsdl_parser_context_parse_string(context, "tag 2147483647 -2147483648 2147483648 -9223372036854775808 9223372036854775807L 0.000000000000000000000000123 12345678901234567890.5 -0.5f");
+	g_assert_cmpstr(result->str, ==, "(tag,gint:2147483647,gint:-2147483648,gint64:2147483648,gint64:-9223372036854775808,gint64:9223372036854775807,gdouble:0.000000,gdouble:12345678901234567168.000000,gfloat:-0.500000\ntag)\n");
+	g_assert(success);
+
+	g_string_truncate(result, 0);
+	success = gsdl_parser_context_parse_string(context, "tag 9223372036854775808");
+	g_assert_cmpstr(result->str, ==, "E: Integer out of range in <string>, line 1, column 5");
+	g_assert(!success);
+}
+
 void test_parser_value_keywords() {
 	GString *result = g_string_new("");
 	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
@@ -172,7 +250,7 @@ void test_parser_value_binary() {
 	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
 
 	g_assert(context != NULL);
-	bool success = gsdl_parser_context_parse_string(context, "tag [YmluYXJ5] [cGFkZGVkI}GJpbmFyeQ==] [ZW1iZWRkZWQAbnVsbHM=]");
+	bool success = gsdl_parser_context_parse_string(context, "tag [YmluYXJ5] [cGFkZGVkI\nGJpbmFyeQ==] [ZW1iZWRkZWQAbnVsbHM=]");
 	g_assert_cmpstr(result->str, ==, "(tag,gsdlbinary:binary,gsdlbinary:padded binary,gsdlbinary:embedded\\\\0nulls\ntag)\n");
 	g_assert(success);
 }
@@ -197,6 +275,574 @@ void test_parser_attr_full() {
 	g_assert(success);
 }
 
+void test_parser_value_many() {
+	GString *input = g_string_new("many");
+	GString *expected = g_string_new("(many");
+
+	// Enough values to spill over several chunks of the parser's arena.
+	for (int i = 0; i < 3000; i++) {
+		g_string_append_printf(input, " %d", i);
+		g_string_append_printf(expected, ",gint:%d", i);
+	}
+
+	// And enough attributes to move the buffer their names are kept in.
+	for (int i = 0; i < 500; i++) {
+		g_string_append_printf(input, " attribute%d=%d", i, i);
+		g_string_append_printf(expected, ",attribute%d=gint:%d", i, i);
+	}
+
+	g_string_append(input, " {\n\tchild \"value\"\n}\nafter");
+	g_string_append(expected, "\n(child,gchararray:\"value\"\nchild)\nmany)\n(after\nafter)\n");
+
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+	// Parse twice, to make sure the context's memory is correctly reused.
+	for (int i = 0; i < 2; i++) {
+		g_string_truncate(result, 0);
+
+		bool success = gsdl_parser_context_parse_string(context, input->str);
+		g_assert_cmpstr(result->str, ==, expected->str);
+		g_assert(success);
+	}
+}
+
+void test_parser_value_block() {
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&block_appender_parser, (gpointer) result);
+
+	g_assert(context != NULL);
+	bool success = gsdl_parser_context_parse_string(context, "tag 1 \"two\" 3.0 a=4 b=on {\n\tchild\n}");
+	g_assert_cmpstr(result->str, ==, "(tag,gint:1,gchararray:\"two\",gdouble:3.000000,a=gint:4,b=gboolean:TRUE\n(child\nchild)\ntag)\n");
+	g_assert(success);
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+}
+
+void test_parser_nested_deep() {
+	GString *input = g_string_new("");
+	GSDLParser error_parser = { NULL, NULL, error_appender };
+
+	// Far deeper than would fit on the stack if the parser recursed.
+	for (int i = 0; i < 200000; i++) g_string_append(input, "a {\n");
+	for (int i = 0; i < 200000; i++) g_string_append(input, "}\n");
+
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&error_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_parse_string(context, input->str));
+	g_assert_cmpstr(result->str, ==, "");
+
+	gsdl_parser_context_set_max_depth(context, 3);
+	g_assert(gsdl_parser_context_parse_string(context, "a { b { c; d }; e }"));
+	g_assert(!gsdl_parser_context_parse_string(context, "a { b { c { d } } }"));
+	g_assert_cmpstr(result->str, ==, "E: Tags nested more than 3 deep in <string>, line 1, column 13");
+
+	gsdl_parser_context_free(context);
+	g_string_free(input, TRUE);
+	g_string_free(result, TRUE);
+}
+
+void test_parser_error_after_tags() {
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+	g_assert(context != NULL);
+	bool success = gsdl_parser_context_parse_string(context, "one\ntwo 2\nthree \"unterminated");
+	g_assert_cmpstr(result->str, ==, "(one\none)\n(two,gint:2\ntwo)\nE: Missing '\"' in <string>, line 3, column 20");
+	g_assert(!success);
+}
+
+static const char *PUSH_INPUT =
+	"first 1 2.5 -3L \"esc\\\"aped\" `raw` 'x' on null\n"
+	"dates 2012/2/5 5:30:20.5 12:14:34 5d:12:14:34 [YmluYXJ5]; second\n"
+	"// comment\n"
+	"nested /* block\ncomment */ a=\"caf\xc3\xa9\" {\n"
+	"\tinner \\\n"
+	"\t\t\"continued\" {\n"
+	"\t\tinnermost\n"
+	"\t}\n"
+	"}\n"
+	"last";
+
+static void _check_push_chunks(const char *input) {
+	GString *expected = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) expected);
+	bool expected_success = gsdl_parser_context_parse_string(context, input);
+
+	// Push-mode errors report a different filename, of the same length.
+	char *filename = strstr(expected->str, "<string>");
+	if (filename) memcpy(filename, "<stream>", 8);
+
+	GString *result = g_string_new("");
+	context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+	gsize len = strlen(input);
+
+	// Try splitting the input up at every possible point.
+	for (gsize chunk_size = 1; chunk_size <= len; chunk_size++) {
+		g_string_truncate(result, 0);
+
+		for (gsize i = 0; i < len; i += chunk_size) {
+			gsdl_parser_context_feed(context, input + i, MIN(chunk_size, len - i));
+		}
+
+		g_assert(gsdl_parser_context_end(context) == expected_success);
+		g_assert_cmpstr(result->str, ==, expected->str);
+	}
+}
+
+void test_parser_push_chunks() {
+	_check_push_chunks(PUSH_INPUT);
+
+	// Error locations have to come out the same as well.
+	char *with_error = g_strconcat(PUSH_INPUT, "\n\xc3\xa9t\xc3\xa9 1 {\n\t\xc3\xa9t\xc3\xa9 \"unterminated", NULL);
+	_check_push_chunks(with_error);
+}
+
+void test_parser_push_incremental() {
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_feed(context, "one 1", 5));
+	g_assert_cmpstr(result->str, ==, "");
+
+	g_assert(gsdl_parser_context_feed(context, "2\ntwo {", 7));
+	g_assert_cmpstr(result->str, ==, "(one,gint:12\none)\n(two\n");
+
+	g_assert(gsdl_parser_context_feed(context, "\n}\nthree \"unterm", 16));
+	g_assert_cmpstr(result->str, ==, "(one,gint:12\none)\n(two\ntwo)\n");
+
+	g_assert(!gsdl_parser_context_end(context));
+	g_assert_cmpstr(result->str, ==, "(one,gint:12\none)\n(two\ntwo)\nE: Missing '\"' in <stream>, line 4, column 14");
+
+	// A new parse can be started once the last one has ended.
+	g_string_truncate(result, 0);
+	g_assert(gsdl_parser_context_feed(context, "four\n", 5));
+	g_assert(gsdl_parser_context_end(context));
+	g_assert_cmpstr(result->str, ==, "(four\nfour)\n");
+}
+
+void test_parser_value_lazy() {
+	const char *inputs[] = {
+		PUSH_INPUT,
+		"tag 2042/4/20 2012/2/5 5:30 \"c\" 1924/11/4 19:34:5 \"b\" 2001/02/23 4:00:23.52 2040/2/3 4:00-America/Denver 502/10/10 12:00:00-GMT+4:15",
+		"[ZW1iZWRkZWQAbnVsbHM=] int=58 long=-32L double=52.3 float=25.3f big=-8923.33bd bool=true nil=null str=\"abc\" date=2042/4/20 timespan=42:00:52 timespan2=-2d:20:42:32.324",
+		"tag -2147483648 2147483648 \"es\\\"caped\" \"line\\\n  continued\"; next 99999999999999999999",
+	};
+
+	// Decoding every value has to give exactly what the eager parser would have.
+	for (gsize i = 0; i < G_N_ELEMENTS(inputs); i++) {
+		GString *expected = g_string_new(""), *result = g_string_new("");
+		GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) expected);
+		bool expected_success = gsdl_parser_context_parse_string(context, inputs[i]);
+		gsdl_parser_context_free(context);
+
+		context = gsdl_parser_context_new(&lazy_appender_parser, (gpointer) result);
+		g_assert(gsdl_parser_context_parse_string(context, inputs[i]) == expected_success);
+		g_assert_cmpstr(result->str, ==, expected->str);
+
+		// Including when the tokens of a value arrive separately.
+		g_string_truncate(result, 0);
+		for (const char *p = inputs[i]; *p; p++) gsdl_parser_context_feed(context, p, 1);
+		g_assert(gsdl_parser_context_end(context) == expected_success);
+		char *filename = strstr(expected->str, "<string>");
+		if (filename) memcpy(filename, "<stream>", 8);
+		g_assert_cmpstr(result->str, ==, expected->str);
+
+		gsdl_parser_context_free(context);
+	}
+}
+
+static void _start_tag_filter(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GSDLValueRef *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GSDLValueRef *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	for (guint i = 0; i < n_attrs; i++) {
+		if (strcmp(attr_names[i], "id") != 0) continue;
+
+		GValue value = G_VALUE_INIT;
+		if (!gsdl_parser_context_decode(context, &attr_values[i], &value, err)) return;
+
+		g_string_append_printf((GString*) user_data, "%s:%d\n", name, g_value_get_int(&value));
+		g_value_unset(&value);
+	}
+}
+
+void test_parser_value_lazy_filter() {
+	GSDLParser filter_parser = { NULL, NULL, error_appender, NULL, _start_tag_filter };
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&filter_parser, (gpointer) result);
+
+	// Values that are never decoded are only checked for correct syntax.
+	g_assert(gsdl_parser_context_parse_string(context, "a 99999999999999999999 id=1 {\n\tb 2012/2/30 id=2\n}\nc id=3 other=1.5"));
+	g_assert_cmpstr(result->str, ==, "a:1\nb:2\nc:3\n");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a id=1\nb id=99999999999999999999"));
+	g_assert_cmpstr(result->str, ==, "a:1\nE: Integer out of range in <string>, line 2, column 6");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a id=2012/"));
+	g_assert_cmpstr(result->str, ==, "E: Unexpected EOF, expected one of: date part in <string>, line 1, column 11");
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+}
+
+static void _start_tag_skipper(
+		GSDLParserContext *context,
+		const gchar *name,
+		GValue* const *values,
+		gchar* const *attr_names,
+		GValue* const *attr_values,
+		gpointer user_data,
+		GError **err
+	) {
+
+	start_tag_appender(context, name, values, attr_names, attr_values, user_data, err);
+
+	if (strcmp(name, "skip") == 0) gsdl_parser_context_skip_children(context);
+}
+
+void test_parser_skip_children() {
+	GSDLParser skip_parser = { _start_tag_skipper, end_tag_appender, error_appender };
+	const char *input =
+		"a {\n"
+		"\tskip 1 {\n"
+		"\t\tb \"}\\\"}\" `}` '}' [fQ==] {\n"
+		"\t\t\tc // }\n"
+		"\t\t\td -- }\n"
+		"\t\t\te # }\n"
+		"\t\t\t/* } */ f 1--2 \xc3\xa9t\xc3\xa9 99999999999999999999 2012/ ==\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tskip; g\n"
+		"}\n"
+		"h";
+	const char *expected = "(a\n(skip,gint:1\nskip)\n(skip\nskip)\n(g\ng)\na)\n(h\nh)\n";
+
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&skip_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_parse_string(context, input));
+	g_assert_cmpstr(result->str, ==, expected);
+
+	// Skipping keeps its place when the input runs out partway through the block.
+	gsize len = strlen(input);
+	for (gsize chunk_size = 1; chunk_size <= len; chunk_size++) {
+		g_string_truncate(result, 0);
+
+		for (gsize i = 0; i < len; i += chunk_size) {
+			g_assert(gsdl_parser_context_feed(context, input + i, MIN(chunk_size, len - i)));
+		}
+
+		g_assert(gsdl_parser_context_end(context));
+		g_assert_cmpstr(result->str, ==, expected);
+	}
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "skip {\n\ta {\n\t\tb \"}\"\n\t}\n"));
+	g_assert_cmpstr(result->str, ==, "(skip\nE: Missing '}' in <string>, line 5, column 1");
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+}
+
+void test_parser_projection() {
+	const char *input =
+		"\"anonymous\" 1 { listener port=1 }\n"
+		"server \"main\" 99999999999999999999 {\n"
+		"\tlistener host=\"a\" port=80 extra=2012/2/30 { child }\n"
+		"\tlistener port=81; other \"}\" { listener port=82 }\n"
+		"}\n"
+		"junk '{' { x 1e { y } }\n"
+		"cluster {\n"
+		"\ta { node 1 }\n"
+		"\tb /* } */ {\n"
+		"\t\tnode 2 { node 3 }\n"
+		"\t}\n"
+		"}";
+	const char *expected = "(listener,port=gint:80\nlistener)\n(listener,port=gint:81\nlistener)\n(node,gint:1\nnode)\n(node,gint:2\nnode)\n";
+	GSDLParser *parsers[] = { &appender_parser, &lazy_appender_parser };
+
+	for (gsize i = 0; i < G_N_ELEMENTS(parsers); i++) {
+		GString *result = g_string_new("");
+		GSDLParserContext *context = gsdl_parser_context_new(parsers[i], (gpointer) result);
+
+		g_assert(gsdl_parser_context_add_projection(context, "server/listener@port", NULL));
+		g_assert(gsdl_parser_context_add_projection(context, "cluster/*/node", NULL));
+
+		g_assert(gsdl_parser_context_parse_string(context, input));
+		g_assert_cmpstr(result->str, ==, expected);
+
+		g_string_truncate(result, 0);
+		for (const char *p = input; *p; p++) g_assert(gsdl_parser_context_feed(context, p, 1));
+		g_assert(gsdl_parser_context_end(context));
+		g_assert_cmpstr(result->str, ==, expected);
+
+		// Everything is parsed again once the projections are gone.
+		gsdl_parser_context_clear_projections(context);
+		g_string_truncate(result, 0);
+		g_assert(!gsdl_parser_context_parse_string(context, input));
+		g_assert(g_str_has_suffix(result->str, "E: Integer out of range in <string>, line 2, column 15"));
+
+		gsdl_parser_context_free(context);
+		g_string_free(result, TRUE);
+	}
+
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, NULL);
+	GError *err = NULL;
+
+	g_assert(!gsdl_parser_context_add_projection(context, "a//b", &err));
+	g_assert_cmpint(err->code, ==, GSDL_SYNTAX_ERROR_BAD_PATH);
+	g_assert_cmpstr(err->message, ==, "Expected tag name or '*' at character 3 of path \"a//b\"");
+	g_clear_error(&err);
+
+	g_assert(!gsdl_parser_context_add_projection(context, "a@b/c", &err));
+	g_assert_cmpstr(err->message, ==, "Expected '/' or '@' at character 4 of path \"a@b/c\"");
+	g_clear_error(&err);
+
+	g_assert(!gsdl_parser_context_add_projection(context, "a@", &err));
+	g_assert_cmpstr(err->message, ==, "Expected attribute name at character 3 of path \"a@\"");
+	g_clear_error(&err);
+
+	g_assert(!gsdl_parser_context_add_projection(context, "a@b=\"c\"/d", &err));
+	g_assert_cmpstr(err->message, ==, "Projections cannot check attribute values, in path \"a@b=\"c\"/d\"");
+	g_clear_error(&err);
+
+	gsdl_parser_context_free(context);
+}
+
+void test_parser_projection_cr() {
+	// Skipped tags end at a lone '\r' as well as at '\n'.
+	const char *inputs[] = {
+		"junk 1\rserver {\r\tlistener port=80\r\tjunk 2\r\tlistener port=81\r}",
+		"junk 1\r\nserver {\r\n\tlistener port=80\r\n\tjunk 2\r\n\tlistener port=81\r\n}",
+	};
+	const char *expected = "(listener,port=gint:80\nlistener)\n(listener,port=gint:81\nlistener)\n";
+
+	for (gsize i = 0; i < G_N_ELEMENTS(inputs); i++) {
+		GString *result = g_string_new("");
+		GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+		g_assert(gsdl_parser_context_add_projection(context, "server/listener@port", NULL));
+
+		g_assert(gsdl_parser_context_parse_string(context, inputs[i]));
+		g_assert_cmpstr(result->str, ==, expected);
+
+		g_string_truncate(result, 0);
+		for (const char *p = inputs[i]; *p; p++) g_assert(gsdl_parser_context_feed(context, p, 1));
+		g_assert(gsdl_parser_context_end(context));
+		g_assert_cmpstr(result->str, ==, expected);
+
+		gsdl_parser_context_free(context);
+		g_string_free(result, TRUE);
+	}
+}
+
+void test_parser_collect_spec() {
+	GValue values[2] = { G_VALUE_INIT, G_VALUE_INIT }, attr_values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+	GValue *value_ptrs[] = { &values[0], &values[1], NULL };
+	GValue *attr_value_ptrs[] = { &attr_values[0], &attr_values[1], &attr_values[2], NULL };
+	gchar *attr_names[] = { "port", "extra", "port", NULL };
+	GValue *out[5];
+	GError *err = NULL;
+
+	g_value_init(&values[0], G_TYPE_INT);
+	g_value_set_int(&values[0], 5);
+	g_value_init(&values[1], G_TYPE_STRING);
+	g_value_set_static_string(&values[1], "a");
+	g_value_init(&attr_values[0], G_TYPE_INT);
+	g_value_set_int(&attr_values[0], 80);
+	g_value_init(&attr_values[1], G_TYPE_POINTER);
+	g_value_init(&attr_values[2], G_TYPE_INT);
+
+	GSDLCollectSpec *spec = gsdl_collect_spec_new();
+	gsdl_collect_spec_add_value(spec, G_TYPE_INT64);
+	gsdl_collect_spec_add_attribute(spec, "port", G_TYPE_INT64);
+	gsdl_collect_spec_add_value(spec, GSDL_GTYPE_ANY);
+	gsdl_collect_spec_add_attribute(spec, "host", G_TYPE_STRING | GSDL_GTYPE_OPTIONAL);
+	gsdl_collect_spec_add_value(spec, G_TYPE_DOUBLE | GSDL_GTYPE_OPTIONAL);
+
+	g_assert(gsdl_collect_spec_apply(spec, "listen", value_ptrs, attr_names, attr_value_ptrs, out, &err));
+	g_assert_cmpint(g_value_get_int64(out[0]), ==, 5);
+	g_assert_cmpint(g_value_get_int64(out[1]), ==, 80);
+	g_assert_cmpstr(g_value_get_string(out[2]), ==, "a");
+	g_assert(out[3] == NULL && out[4] == NULL);
+
+	for (int i = 0; i < 3; i++) {
+		g_value_unset(out[i]);
+		g_slice_free(GValue, out[i]);
+	}
+
+	// Errors are the same as those from gsdl_parser_collect_values() and gsdl_parser_collect_attributes().
+	GValue *collected;
+
+	gsdl_collect_spec_add_attribute(spec, "extra", G_TYPE_INT);
+	g_assert(!gsdl_collect_spec_apply(spec, "listen", value_ptrs, attr_names, attr_value_ptrs, out, &err));
+	g_assert_cmpstr(err->message, ==, "Tag \"listen\" requires attribute \"extra\" of type gint, got gpointer");
+	g_clear_error(&err);
+
+	g_assert(!gsdl_parser_collect_attributes("listen", attr_names, attr_value_ptrs, &err, G_TYPE_INT, "extra", &collected, GSDL_GTYPE_END));
+	g_assert_cmpstr(err->message, ==, "Tag \"listen\" requires attribute \"extra\" of type gint, got gpointer");
+	g_clear_error(&err);
+
+	value_ptrs[1] = NULL;
+	g_assert(!gsdl_collect_spec_apply(spec, "listen", value_ptrs, attr_names, attr_value_ptrs, out, &err));
+	g_assert_cmpint(err->code, ==, GSDL_SYNTAX_ERROR_MISSING_VALUE);
+	g_assert_cmpstr(err->message, ==, "Tag \"listen\" requires value 2");
+	g_clear_error(&err);
+
+	g_assert(!gsdl_parser_collect_values("listen", value_ptrs, &err, G_TYPE_INT, &collected, G_TYPE_INT, &collected, GSDL_GTYPE_END));
+	g_assert_cmpstr(err->message, ==, "Tag \"listen\" requires value 2");
+	g_clear_error(&err);
+	g_value_unset(collected);
+	g_slice_free(GValue, collected);
+
+	gsdl_collect_spec_free(spec);
+	g_value_unset(&values[1]);
+}
+
+static void _start_tag_typed(
+		GSDLParserContext *context,
+		const gchar *name,
+		GValue* const *values,
+		gchar* const *attr_names,
+		GValue* const *attr_values,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GString *result = (GString*) user_data;
+	gint64 port, big;
+	gdouble ratio;
+	const gchar *str;
+	const GDateTime *when;
+	const guint8 *data;
+	gsize len;
+
+	if (!(
+		gsdl_attr_get_int64(attr_names, attr_values, "port", &port, err) &&
+		gsdl_attr_get_int64(attr_names, attr_values, "big", &big, err) &&
+		gsdl_attr_get_double(attr_names, attr_values, "ratio", &ratio, err) &&
+		gsdl_attr_get_string(attr_names, attr_values, "str", &str, err) &&
+		gsdl_attr_get_datetime(attr_names, attr_values, "when", &when, err) &&
+		gsdl_attr_get_bytes(attr_names, attr_values, "data", &data, &len, err)
+	)) return;
+
+	g_string_append_printf(result, "%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %f %s %d %.*s\n", port, big, ratio, str, g_date_time_get_year((GDateTime*) when), (int) len, data);
+}
+
+void test_parser_typed_accessors() {
+	GSDLParser typed_parser = { _start_tag_typed, NULL, error_appender };
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&typed_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_parse_string(context, "a port=80 big=5000000000L ratio=1.5f str=\"s\" when=2012/2/5 12:00:00 data=[YmluYXJ5]\nb port=1 big=2 ratio=3 str=\"\" when=1999/12/31 23:59 data=[]"));
+	g_assert_cmpstr(result->str, ==, "80 5000000000 1.500000 s 2012 binary\n1 2 3.000000  1999 \n");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a port=80"));
+	g_assert_cmpstr(result->str, ==, "E: Missing attribute \"big\"");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a port=\"80\""));
+	g_assert_cmpstr(result->str, ==, "E: Attribute \"port\" should be an integer, got gchararray");
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+}
+
+static void _start_tag_typed_block(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GValue *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GValue *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	GString *result = (GString*) user_data;
+	gint64 port;
+	gdouble ratio;
+	const gchar *str;
+	const GDateTime *when;
+	const guint8 *data;
+	gsize len;
+
+	if (!(
+		gsdl_attr_block_get_int64(attr_names, attr_values, n_attrs, "port", &port, err) &&
+		gsdl_attr_block_get_double(attr_names, attr_values, n_attrs, "ratio", &ratio, err) &&
+		gsdl_attr_block_get_string(attr_names, attr_values, n_attrs, "str", &str, err) &&
+		gsdl_attr_block_get_datetime(attr_names, attr_values, n_attrs, "when", &when, err) &&
+		gsdl_attr_block_get_bytes(attr_names, attr_values, n_attrs, "data", &data, &len, err)
+	)) return;
+
+	g_string_append_printf(result, "%" G_GINT64_FORMAT " %f %s %d %.*s\n", port, ratio, str, g_date_time_get_year((GDateTime*) when), (int) len, data);
+}
+
+void test_parser_typed_block_accessors() {
+	GSDLParser typed_parser = { NULL, NULL, error_appender, _start_tag_typed_block };
+	GString *result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&typed_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_parse_string(context, "a port=80 ratio=1.5f str=\"s\" when=2012/2/5 12:00:00 data=[YmluYXJ5]"));
+	g_assert_cmpstr(result->str, ==, "80 1.500000 s 2012 binary\n");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a ratio=1"));
+	g_assert_cmpstr(result->str, ==, "E: Missing attribute \"port\"");
+
+	g_string_truncate(result, 0);
+	g_assert(!gsdl_parser_context_parse_string(context, "a port=80 ratio=\"1\""));
+	g_assert_cmpstr(result->str, ==, "E: Attribute \"ratio\" should be a number, got gchararray");
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+}
+
+void test_parser_reset() {
+	GString *result = g_string_new(""), *pushed_result = g_string_new("");
+	GSDLParserContext *context = gsdl_parser_context_new(&appender_parser, (gpointer) result);
+
+	g_assert(gsdl_parser_context_feed(context, "outer {\ninner 1 2", 17));
+	g_assert_cmpstr(result->str, ==, "(outer\n");
+
+	// Abandons the parse in the middle, along with the pushed callbacks.
+	gsdl_parser_context_push(context, &appender_parser, (gpointer) pushed_result);
+	gsdl_parser_context_reset(context);
+
+	for (int i = 0; i < 3; i++) {
+		g_string_truncate(result, 0);
+		g_assert(gsdl_parser_context_parse_string(context, "one 1 { two a=2; }"));
+		g_assert_cmpstr(result->str, ==, "(one,gint:1\n(two,a=gint:2\ntwo)\none)\n");
+
+		g_string_truncate(result, 0);
+		g_assert(!gsdl_parser_context_parse_string(context, "one {\n\ttwo \"unterminated"));
+		g_assert_cmpstr(result->str, ==, "(one\nE: Missing '\"' in <string>, line 2, column 19");
+
+		gsdl_parser_context_reset(context);
+	}
+
+	g_assert_cmpstr(pushed_result->str, ==, "");
+
+	gsdl_parser_context_free(context);
+	g_string_free(result, TRUE);
+	g_string_free(pushed_result, TRUE);
+}
+
 void test_parser_file_full() {
 	char *filename;
 	GIOChannel *channel = g_io_channel_unix_new(g_file_open_tmp("test-tokenizer.XXXXXX", &filename, NULL));
@@ -227,13 +873,30 @@ int main(int argc, char **argv) {
 	TEST(identifier_nested);
 	TEST(identifier_sequence);
 	TEST(value_numbers);
+	TEST(value_numbers_range);
+	TEST(value_numbers_exact);
 	TEST(value_keywords);
 	TEST(value_strings);
 	TEST(value_datetime);
 	TEST(value_timespan);
 	TEST(value_binary);
 	TEST(value_char);
+	TEST(value_many);
 	TEST(attr_full);
+	TEST(value_block);
+	TEST(value_lazy);
+	TEST(value_lazy_filter);
+	TEST(skip_children);
+	TEST(projection);
+	TEST(projection_cr);
+	TEST(collect_spec);
+	TEST(typed_accessors);
+	TEST(typed_block_accessors);
+	TEST(nested_deep);
+	TEST(error_after_tags);
+	TEST(push_chunks);
+	TEST(push_incremental);
+	TEST(reset);
 	TEST(file_full);
 
 	return g_test_run();
@@ -0,0 +1,169 @@
+#include <document.h>
+#include <glib.h>
+#include <query.h>
+#include <string.h>
+#include <syntax.h>
+
+#include "appenders.h"
+
+const char *CLUSTERS = "cluster name=\"main\" {\n"
+	"\tnode name=\"a\" {\n"
+	"\t\tlistener port=80\n"
+	"\t\tlistener port=443 tls=true\n"
+	"\t}\n"
+	"\tnode name=\"b\" {\n"
+	"\t\tlistener port=8080\n"
+	"\t}\n"
+	"}\n"
+	"cluster name=\"backup\" {\n"
+	"\tnode name=\"a\" {\n"
+	"\t\tlistener port=81\n"
+	"\t}\n"
+	"}\n"
+	"node name=\"a\"\n";
+
+// Lists matches as "node" or "node.attr=value", separated by spaces.
+char* query_repr(const GSDLDocument *document, const char *path, guint n_threads) {
+	GError *error = NULL;
+	GSDLQuery *query = gsdl_query_compile(path, &error);
+
+	g_assert_no_error(error);
+
+	guint n_matches;
+	GSDLQueryMatch *matches = gsdl_query_exec(query, document, n_threads, &n_matches);
+	GString *result = g_string_new("");
+
+	for (guint i = 0; i < n_matches; i++) {
+		if (i) g_string_append_c(result, ' ');
+		g_string_append_printf(result, "%u", matches[i].node);
+
+		if (matches[i].attr_name) {
+			g_string_append_printf(result, ".%s=", matches[i].attr_name);
+
+			if (matches[i].value->type == GSDL_DOC_STRING) {
+				g_string_append(result, matches[i].value->v_str);
+			} else {
+				g_string_append_printf(result, "%" G_GINT64_FORMAT, matches[i].value->v_int);
+			}
+		}
+	}
+
+	g_free(matches);
+	gsdl_query_free(query);
+
+	return g_string_free(result, FALSE);
+}
+
+#define ASSERT_QUERY(path, expected) ASSERT_REPR(query_repr(document, path, 1), expected)
+
+void test_query_simple() {
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string(CLUSTERS, &error);
+
+	g_assert_no_error(error);
+
+	ASSERT_QUERY("node", "10");
+	ASSERT_QUERY("*/node", "2 5 8");
+	ASSERT_QUERY("cluster/node/*", "3 4 6 9");
+	ASSERT_QUERY("*/*/*", "3 4 6 9");
+	ASSERT_QUERY("cluster/node/listener/*", "");
+	ASSERT_QUERY("listener", "");
+	ASSERT_QUERY("missing/node", "");
+	ASSERT_QUERY("cluster/node@name", "2.name=a 5.name=b 8.name=a");
+	ASSERT_QUERY("cluster/node/listener@tls@port", "3.port=80 4.tls=1 4.port=443 6.port=8080 9.port=81");
+	ASSERT_QUERY("cluster/node/listener@missing", "");
+
+	gsdl_document_free(document);
+}
+
+void test_query_predicates() {
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string(CLUSTERS, &error);
+
+	g_assert_no_error(error);
+
+	ASSERT_QUERY("cluster/node@name=\"a\"/listener@port", "3.port=80 4.port=443 9.port=81");
+	ASSERT_QUERY("cluster@name=\"main\"/node@name=\"a\"/listener@port", "3.port=80 4.port=443");
+	ASSERT_QUERY("cluster/*/listener@port=80", "3");
+	ASSERT_QUERY("*/*/*@port=8080", "6");
+	ASSERT_QUERY("cluster/node/listener@port=443@tls=1", "");
+	ASSERT_QUERY("node@name=\"a\"", "10");
+	ASSERT_QUERY("*@name=\"a\"", "10");
+	ASSERT_QUERY("*/*@name=\"a\"", "2 8");
+	ASSERT_QUERY("*/*@name=\"c\"", "");
+	ASSERT_QUERY("*/*@missing=\"a\"", "");
+	ASSERT_QUERY("cluster/node@name=80", "");
+
+	// A check that matches nothing rules out every candidate, whatever the other checks match.
+	ASSERT_QUERY("*/*@name=\"c\"@name=\"a\"", "");
+
+	// Queries can be run any number of times against the same document.
+	ASSERT_QUERY("cluster/node@name=\"a\"/listener@port", "3.port=80 4.port=443 9.port=81");
+
+	gsdl_document_free(document);
+}
+
+void test_query_bad_path() {
+	GError *error = NULL;
+
+	g_assert(gsdl_query_compile("a@b=", &error) == NULL);
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_BAD_PATH);
+	g_assert_cmpstr(error->message, ==, "Expected string or integer at character 5 of path \"a@b=\"");
+	g_clear_error(&error);
+
+	g_assert(gsdl_query_compile("a@b=\"c", &error) == NULL);
+	g_assert_cmpstr(error->message, ==, "Expected '\"' at character 7 of path \"a@b=\"c\"");
+	g_clear_error(&error);
+
+	g_assert(gsdl_query_compile("a@b=c", &error) == NULL);
+	g_assert_cmpstr(error->message, ==, "Expected string or integer at character 5 of path \"a@b=c\"");
+	g_clear_error(&error);
+
+	GSDLQuery *query = gsdl_query_compile("a@b=\"say \\\"hi\\\"\"@c=-5/d", &error);
+	g_assert_no_error(error);
+	gsdl_query_free(query);
+}
+
+void test_query_parallel() {
+	GString *input = g_string_new("");
+
+	for (int i = 0; i < 5000; i++) g_string_append_printf(input, "group id=%d {\n\titem k=%d\n\titem k=\"x\"\n}\n", i, i % 7);
+
+	GError *error = NULL;
+	GSDLDocument *document = gsdl_document_new_from_string(input->str, &error);
+
+	g_assert_no_error(error);
+	g_assert_cmpint(gsdl_document_get_n_nodes(document), ==, 15001);
+
+	const char *paths[] = { "group/item", "group/*", "*/item@k", "group/item@k=3", "*@id=4200", "*/*@k=\"x\"" };
+	guint counts[] = { 10000, 10000, 10000, 714, 1, 5000 };
+
+	for (int i = 0; i < G_N_ELEMENTS(paths); i++) {
+		char *serial = query_repr(document, paths[i], 1), *parallel = query_repr(document, paths[i], 4);
+		char **matches = g_strsplit(serial, " ", -1);
+
+		g_assert_cmpint(g_strv_length(matches), ==, counts[i]);
+		g_assert_cmpstr(serial, ==, parallel);
+
+		g_strfreev(matches);
+		g_free(serial);
+		g_free(parallel);
+	}
+
+	gsdl_document_free(document);
+	g_string_free(input, TRUE);
+}
+
+#define TEST(name) g_test_add_func("/query/"#name, test_query_##name)
+
+int main(int argc, char **argv) {
+	g_type_init();
+	g_test_init(&argc, &argv, NULL);
+
+	TEST(simple);
+	TEST(predicates);
+	TEST(bad_path);
+	TEST(parallel);
+
+	return g_test_run();
+}
@@ -0,0 +1,145 @@
+#include <glib.h>
+#include <reader.h>
+#include <string.h>
+#include <syntax.h>
+#include <unistd.h>
+
+#include "appenders.h"
+
+// Reads events until EOF or an error, in the same format as the parser tests' appender.
+char* reader_repr(GSDLReader *reader, const char *skip) {
+	GString *result = g_string_new("");
+	GSDLReaderEvent event;
+	GError *error = NULL;
+
+	while (gsdl_reader_next(reader, &event, &error) && event.type != GSDL_READER_EOF) {
+		if (event.type == GSDL_READER_END) {
+			g_string_append_printf(result, "%s)\n", event.name);
+			continue;
+		}
+
+		g_string_append_c(result, '(');
+		g_string_append(result, event.name);
+
+		for (guint i = 0; i < event.n_values + event.n_attrs; i++) {
+			const GSDLValueRef *ref = i < event.n_values ? &event.values[i] : &event.attr_values[i - event.n_values];
+			GValue value = G_VALUE_INIT;
+
+			g_assert(gsdl_reader_decode(reader, ref, &value, &error));
+
+			append_gvalue(result, i < event.n_values ? NULL : event.attr_names[i - event.n_values], &value);
+			g_value_unset(&value);
+		}
+
+		g_string_append_c(result, '\n');
+
+		if (skip && strcmp(event.name, skip) == 0) gsdl_reader_skip_children(reader);
+	}
+
+	if (error) {
+		g_string_append_printf(result, "E: %s", error->message);
+		g_error_free(error);
+	}
+
+	return g_string_free(result, FALSE);
+}
+
+void test_reader_events() {
+	GError *error = NULL;
+	GSDLReader *reader = gsdl_reader_new_from_string("one 1 \"two\" {\n\tthree a=3L b=\"four\"; five\n\tsix {\n\t}\n}\nseven true", &error);
+
+	g_assert_no_error(error);
+
+	ASSERT_REPR(reader_repr(reader, NULL), "(one,gint:1,gchararray:\"two\"\n(three,a=gint64:3,b=gchararray:\"four\"\nthree)\n(five\nfive)\n(six\nsix)\none)\n(seven,gboolean:TRUE\nseven)\n");
+
+	// The end is sticky.
+	GSDLReaderEvent event;
+	g_assert(gsdl_reader_next(reader, &event, &error));
+	g_assert_cmpint(event.type, ==, GSDL_READER_EOF);
+
+	gsdl_reader_free(reader);
+
+	reader = gsdl_reader_new_from_string("", &error);
+	g_assert(gsdl_reader_next(reader, &event, &error));
+	g_assert_cmpint(event.type, ==, GSDL_READER_EOF);
+	gsdl_reader_free(reader);
+}
+
+void test_reader_skip_children() {
+	GError *error = NULL;
+	GSDLReader *reader = gsdl_reader_new_from_string("a {\n\tb 1 {\n\t\tc 2 = 3\n\t}\n\td\n}", &error);
+
+	ASSERT_REPR(reader_repr(reader, "b"), "(a\n(b,gint:1\nb)\n(d\nd)\na)\n");
+
+	gsdl_reader_free(reader);
+}
+
+void test_reader_stop_early() {
+	GError *error = NULL;
+	GSDLReader *reader = gsdl_reader_new_from_string("a \"first\" {\n\tb \"second\"\n\tc\n}", &error);
+	GSDLReaderEvent event;
+
+	g_assert(gsdl_reader_next(reader, &event, &error));
+	g_assert(gsdl_reader_next(reader, &event, &error));
+	g_assert_cmpint(event.type, ==, GSDL_READER_START);
+	g_assert_cmpstr(event.name, ==, "b");
+	g_assert_cmpint(event.n_values, ==, 1);
+
+	// Leaves the rest unread, with the current tag's values still held.
+	gsdl_reader_free(reader);
+}
+
+void test_reader_errors() {
+	GError *error = NULL;
+	GSDLReader *reader = gsdl_reader_new_from_string("a {\n\tb 1\n\tc \"unterminated", &error);
+
+	ASSERT_REPR(reader_repr(reader, NULL), "(a\n(b,gint:1\nb)\nE: Missing '\"' in <string>, line 3, column 17");
+
+	GSDLReaderEvent event;
+	g_assert(gsdl_reader_next(reader, &event, &error));
+	g_assert_cmpint(event.type, ==, GSDL_READER_EOF);
+	gsdl_reader_free(reader);
+
+	reader = gsdl_reader_new_from_string("a {\n\tb {\n\t\tc\n\t}\n}", &error);
+	gsdl_reader_set_max_depth(reader, 2);
+	ASSERT_REPR(reader_repr(reader, NULL), "(a\n(b\nE: Tags nested more than 2 deep in <string>, line 3, column 3");
+	gsdl_reader_free(reader);
+
+	g_assert(gsdl_reader_new_from_file("/nonexistent/file.sdl", &error) == NULL);
+	g_assert(error != NULL);
+	g_clear_error(&error);
+}
+
+void test_reader_file() {
+	char *filename;
+	GIOChannel *channel = g_io_channel_unix_new(g_file_open_tmp("test-reader.XXXXXX", &filename, NULL));
+	g_io_channel_write_chars(channel, "server host=\"localhost\" {\n\tlistener 80\n}\n", -1, NULL, NULL);
+	g_io_channel_shutdown(channel, true, NULL);
+	g_io_channel_unref(channel);
+
+	GError *error = NULL;
+	GSDLReader *reader = gsdl_reader_new_from_file(filename, &error);
+
+	g_assert_no_error(error);
+
+	ASSERT_REPR(reader_repr(reader, NULL), "(server,host=gchararray:\"localhost\"\n(listener,gint:80\nlistener)\nserver)\n");
+
+	gsdl_reader_free(reader);
+	unlink(filename);
+	g_free(filename);
+}
+
+#define TEST(name) g_test_add_func("/reader/"#name, test_reader_##name)
+
+int main(int argc, char **argv) {
+	g_type_init();
+	g_test_init(&argc, &argv, NULL);
+
+	TEST(events);
+	TEST(skip_children);
+	TEST(stop_early);
+	TEST(errors);
+	TEST(file);
+
+	return g_test_run();
+}
@@ -0,0 +1,141 @@
+#include <glib.h>
+#include <parser.h>
+#include <stream.h>
+#include <string.h>
+#include <syntax.h>
+
+#include "appenders.h"
+
+const char *LOG = "log {\n"
+	"\tevent 1 level=\"info\"\n"
+	"\tevent 2 level=\"error\" {\n"
+	"\t\tdetail \"x\"\n"
+	"\t}\n"
+	"\tother level=\"error\"\n"
+	"\tevent 3 code=5 level=\"error\"\n"
+	"}\n"
+	"event 4 level=\"error\"\n"
+	"log name=\"b\" {\n"
+	"\tnested {\n"
+	"\t\tevent 5 level=\"error\"\n"
+	"\t}\n"
+	"\tevent 6 level=\"error\" code=5L\n"
+	"}\n";
+
+// Like start_tag_block_appender, but fails on a tag whose first value is 99.
+void start_tag_stopper(
+		GSDLParserContext *context,
+		const gchar *name,
+		const GValue *values,
+		guint n_values,
+		gchar* const *attr_names,
+		const GValue *attr_values,
+		guint n_attrs,
+		gpointer user_data,
+		GError **err
+	) {
+
+	start_tag_block_appender(context, name, values, n_values, attr_names, attr_values, n_attrs, user_data, err);
+
+	if (n_values && G_VALUE_HOLDS_INT(&values[0]) && g_value_get_int(&values[0]) == 99) {
+		g_set_error(err, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_UNEXPECTED_TAG, "Stopped at 99");
+	}
+}
+
+void error_appender(
+		GSDLParserContext *context,
+		GError *err,
+		gpointer user_data
+	) {
+
+	GString *result = (GString*) user_data;
+
+	g_string_append(result, "E: ");
+	g_string_append(result, err->message);
+	g_error_free(err);
+}
+
+GSDLParser appender_parser = {
+	NULL,
+	NULL,
+	error_appender,
+	start_tag_stopper,
+};
+
+// Runs a query over a string, all at once and then, if push is set, one byte at a time.
+char* stream_repr(const char *path, const char *input, bool push) {
+	GError *error = NULL;
+	GString *result = g_string_new("");
+	GSDLStreamQuery *query = gsdl_stream_query_new(path, &appender_parser, result, &error);
+	GSDLParserContext *context = gsdl_stream_query_get_context(query);
+
+	g_assert_no_error(error);
+
+	gsdl_parser_context_parse_string(context, input);
+	char *expected = g_strdup(result->str);
+
+	if (push) {
+		g_string_truncate(result, 0);
+		gsdl_parser_context_reset(context);
+
+		bool success = true;
+		for (gsize i = 0; input[i] && success; i++) success = gsdl_parser_context_feed(context, input + i, 1);
+		if (success) gsdl_parser_context_end(context);
+
+		g_assert_cmpstr(result->str, ==, expected);
+	}
+
+	g_free(expected);
+	gsdl_stream_query_free(query);
+
+	return g_string_free(result, FALSE);
+}
+
+#define ASSERT_STREAM(path, input, expected) ASSERT_REPR(stream_repr(path, input, true), expected)
+#define ASSERT_STREAM_STRING(path, input, expected) ASSERT_REPR(stream_repr(path, input, false), expected)
+
+void test_stream_simple() {
+	ASSERT_STREAM("log/event", LOG, "(event,gint:1,level=gchararray:\"info\"\n(event,gint:2,level=gchararray:\"error\"\n(event,gint:3,code=gint:5,level=gchararray:\"error\"\n(event,gint:6,level=gchararray:\"error\",code=gint64:5\n");
+	ASSERT_STREAM("*/*/event", LOG, "(event,gint:5,level=gchararray:\"error\"\n");
+	ASSERT_STREAM("event", LOG, "(event,gint:4,level=gchararray:\"error\"\n");
+	ASSERT_STREAM("log/event/detail", LOG, "(detail,gchararray:\"x\"\n");
+	ASSERT_STREAM("log/event@level=\"info\"/detail", LOG, "");
+	ASSERT_STREAM("log/event@code", LOG, "(event,gint:1\n(event,gint:2\n(event,gint:3,code=gint:5\n(event,gint:6,code=gint64:5\n");
+}
+
+void test_stream_predicates() {
+	ASSERT_STREAM("log/event@level=\"error\"", LOG, "(event,gint:2,level=gchararray:\"error\"\n(event,gint:3,code=gint:5,level=gchararray:\"error\"\n(event,gint:6,level=gchararray:\"error\",code=gint64:5\n");
+	ASSERT_STREAM("log/event@level=\"error\"@code", LOG, "(event,gint:2\n(event,gint:3,code=gint:5\n(event,gint:6,code=gint64:5\n");
+	ASSERT_STREAM("*/event@code=5", LOG, "(event,gint:3,code=gint:5,level=gchararray:\"error\"\n(event,gint:6,level=gchararray:\"error\",code=gint64:5\n");
+	ASSERT_STREAM("log@name=\"b\"/event", LOG, "(event,gint:6,level=gchararray:\"error\",code=gint64:5\n");
+	ASSERT_STREAM("log@name=\"b\"/*/event@level=\"error\"", LOG, "(event,gint:5,level=gchararray:\"error\"\n");
+	ASSERT_STREAM("*@level=\"error\"", LOG, "(event,gint:4,level=gchararray:\"error\"\n");
+	ASSERT_STREAM("log/event@level=\"warning\"", LOG, "");
+}
+
+void test_stream_errors() {
+	// Errors inside tags that cannot match are never noticed.
+	ASSERT_STREAM("log/event", "log { event 1 }\nother { 1 2 = 3 }\nlog { event 2 }", "(event,gint:1\n(event,gint:2\n");
+	ASSERT_STREAM_STRING("log/event", "log {\n\tevent 1\n\tevent 2 bad 3\n}", "(event,gint:1\nE: Unexpected number, expected one of: '=' in <string>, line 3, column 14");
+
+	// As can errors from the callbacks.
+	ASSERT_STREAM("log/event", "log {\n\tevent 1\n\tevent 99\n\tevent 2\n}", "(event,gint:1\n(event,gint:99\nE: Stopped at 99");
+
+	GError *error = NULL;
+	g_assert(gsdl_stream_query_new("log/", &appender_parser, NULL, &error) == NULL);
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_BAD_PATH);
+	g_clear_error(&error);
+}
+
+#define TEST(name) g_test_add_func("/stream/"#name, test_stream_##name)
+
+int main(int argc, char **argv) {
+	g_type_init();
+	g_test_init(&argc, &argv, NULL);
+
+	TEST(simple);
+	TEST(predicates);
+	TEST(errors);
+
+	return g_test_run();
+}
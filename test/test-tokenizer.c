@@ -1,9 +1,12 @@
 #include <glib.h>
+#include <idchar.h>
+#include <string.h>
+#include <syntax.h>
 #include <tokenizer.h>
 #include <unistd.h>
 
 #define ASSERT_TOKEN(t) do { bool success = gsdl_tokenizer_next(tokenizer, &token, &error); g_assert_no_error(error); g_assert(success); g_assert_cmpint(token->type, ==, t); } while(0)
-#define ASSERT_TOKEN_VAL(t, v) do { bool success = gsdl_tokenizer_next(tokenizer, &token, &error); g_assert_no_error(error); g_assert(success); g_assert_cmpint(token->type, ==, t); g_assert_cmpstr(token->val, ==, v); } while(0)
+#define ASSERT_TOKEN_VAL(t, v) do { bool success = gsdl_tokenizer_next(tokenizer, &token, &error); g_assert_no_error(error); g_assert(success); g_assert_cmpint(token->type, ==, t); char *val = g_strndup(token->val, token->len); g_assert_cmpstr(val, ==, v); g_free(val); } while(0)
 
 void test_tokenizer_string_simple() {
 	GError *error = NULL;
@@ -51,6 +54,19 @@ void test_tokenizer_string_comments() {
 	ASSERT_TOKEN_VAL(T_NUMBER, "5");
 	ASSERT_TOKEN(T_EOF);
 	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+
+	tokenizer = gsdl_tokenizer_new_from_string("tag \\\n  1 \\\r\n  2\r\n3", &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "tag");
+	ASSERT_TOKEN_VAL(T_NUMBER, "1");
+	ASSERT_TOKEN_VAL(T_NUMBER, "2");
+	ASSERT_TOKEN('\n');
+	ASSERT_TOKEN_VAL(T_NUMBER, "3");
+	ASSERT_TOKEN(T_EOF);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
 }
 
 void test_tokenizer_string_numbers() {
@@ -75,6 +91,26 @@ void test_tokenizer_string_numbers() {
 	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
 }
 
+void test_tokenizer_string_number_values() {
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("0042 18446744073709551615 18446744073709551616 5d:", &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	ASSERT_TOKEN_VAL(T_NUMBER, "0042");
+	g_assert_cmpuint(token->num, ==, 42);
+	ASSERT_TOKEN(T_NUMBER);
+	g_assert_cmpuint(token->num, ==, G_MAXUINT64);
+	g_assert_cmpint(token->len, ==, 20);
+	ASSERT_TOKEN(T_NUMBER);
+	g_assert_cmpuint(token->num, ==, G_MAXUINT64);
+	ASSERT_TOKEN(T_DAYS);
+	g_assert_cmpuint(token->num, ==, 5);
+	ASSERT_TOKEN(T_EOF);
+}
+
 void test_tokenizer_string_strings() {
 	GError *error = NULL;
 	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("'c' '\\'' \"simple\" \"escapes\\t\\\"\" \"multiple \\\n     lines\" `backquote  \r\n  st\\ring`", &error);
@@ -95,7 +131,7 @@ void test_tokenizer_string_strings() {
 
 void test_tokenizer_string_identifiers() {
 	GError *error = NULL;
-	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("myName myName123 my-name my_name _my-name my_name_ com.ikayzo.foo", &error);
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("myName myName123 my-name my_name _my-name my_name_ com.ikayzo.foo $cost", &error);
 
 	g_assert_no_error(error);
 	g_assert(tokenizer != NULL);
@@ -108,10 +144,19 @@ void test_tokenizer_string_identifiers() {
 	ASSERT_TOKEN_VAL(T_IDENTIFIER, "_my-name");
 	ASSERT_TOKEN_VAL(T_IDENTIFIER, "my_name_");
 	ASSERT_TOKEN_VAL(T_IDENTIFIER, "com.ikayzo.foo");
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "$cost");
 	ASSERT_TOKEN(T_EOF);
 	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
 }
 
+extern bool _gsdl_tokenizer_is_identifier_char(gunichar c);
+
+void test_tokenizer_identifier_chars() {
+	for (gunichar c = 0; c <= 0x10ffff; c++) {
+		g_assert_cmpint(_gsdl_tokenizer_is_identifier_char(c), ==, _gsdl_unichar_is_identifier(c));
+	}
+}
+
 void test_tokenizer_string_keywords() {
 	GError *error = NULL;
 	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("on true ident off nul null false", &error);
@@ -133,16 +178,238 @@ void test_tokenizer_string_keywords() {
 
 void test_tokenizer_string_binary() {
 	GError *error = NULL;
-	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("[a32098astas==] [astasr   arstuoth\narstfu]", &error);
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("[YmluYXJ5] [cGFk ZGVk\n\tIGJp bmFyeQ==] [] [YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXpBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZWjAxMjM0NTY3ODkrLw]", &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	ASSERT_TOKEN_VAL(T_BINARY, "binary");
+	ASSERT_TOKEN_VAL(T_BINARY, "padded binary");
+	ASSERT_TOKEN_VAL(T_BINARY, "");
+	ASSERT_TOKEN_VAL(T_BINARY, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789+/");
+	ASSERT_TOKEN(T_EOF);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+}
+
+void test_tokenizer_string_binary_invalid() {
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("[YmluYXJ5]\n[YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXpBQkNERUZH!ElKS0xNTk9Q]", &error);
+
+	GSDLToken *token;
+	ASSERT_TOKEN(T_BINARY);
+	ASSERT_TOKEN('\n');
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_BAD_LITERAL);
+	g_assert_cmpstr(error->message, ==, "Invalid base64 in binary literal in <string>, line 2, column 46");
+	g_clear_error(&error);
+
+	tokenizer = gsdl_tokenizer_new_from_string("[YmluY==X] [YmluY]", &error);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_cmpstr(error->message, ==, "Invalid base64 in binary literal in <string>, line 1, column 9");
+	g_clear_error(&error);
+
+	tokenizer = gsdl_tokenizer_new_from_string("[YmluY]", &error);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_cmpstr(error->message, ==, "Truncated base64 in binary literal in <string>, line 1, column 7");
+}
+
+void test_tokenizer_string_slices() {
+	GError *error = NULL;
+	const char *input = "tag 42 \"plain\" \"esc\\taped\" '\\n'";
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string(input, &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "tag");
+	g_assert(token->val == input);
+	ASSERT_TOKEN_VAL(T_NUMBER, "42");
+	g_assert(token->val == input + 4);
+	ASSERT_TOKEN_VAL(T_STRING, "plain");
+	g_assert(token->val == input + 8);
+	ASSERT_TOKEN_VAL(T_STRING, "esc\taped");
+	g_assert(token->val < input || token->val >= input + strlen(input));
+	gsdl_token_free(token);
+	ASSERT_TOKEN_VAL(T_CHAR, "\n");
+	ASSERT_TOKEN(T_EOF);
+
+	gsdl_tokenizer_free(tokenizer);
+}
+
+void test_tokenizer_string_long() {
+	GString *input = g_string_new("");
+	GString *expected = g_string_new("");
+
+	// Long enough that the vectorized scanners see several full blocks, with escapes and multi-byte
+	// characters at every offset within a block.
+	for (int i = 0; i < 80; i++) {
+		g_string_append(input, "-- comment \xe2\x80\x93 ");
+		for (int j = 0; j < i; j++) g_string_append_c(input, 'c');
+		g_string_append(input, "\n\"");
+
+		g_string_truncate(expected, 0);
+		for (int j = 0; j < i; j++) {
+			g_string_append_c(input, 'a');
+			g_string_append_c(expected, 'a');
+		}
+		g_string_append(input, "\\t\xc3\xa9\\\\/* x */\"");
+		g_string_append(expected, "\t\xc3\xa9\\/* x */");
+		g_string_append(input, " /* ");
+		for (int j = 0; j < i; j++) g_string_append(input, "*\n");
+		g_string_append(input, "*/ `");
+		for (int j = 0; j < i; j++) g_string_append_c(input, 'b');
+		g_string_append(input, "\r\n`\n");
+	}
+
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string(input->str, &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	guint token_line, token_col;
+	int line = 1;
+	for (int i = 0; i < 80; i++) {
+		g_string_truncate(expected, 0);
+		for (int j = 0; j < i; j++) g_string_append_c(expected, 'a');
+		g_string_append(expected, "\t\xc3\xa9\\/* x */");
+
+		ASSERT_TOKEN('\n');
+		ASSERT_TOKEN_VAL(T_STRING, expected->str);
+		gsdl_tokenizer_get_location(tokenizer, token->offset, &token_line, &token_col);
+		g_assert_cmpint(token_line, ==, line + 1);
+		g_assert_cmpint(token_col, ==, 1);
+
+		g_string_truncate(expected, 0);
+		for (int j = 0; j < i; j++) g_string_append_c(expected, 'b');
+		g_string_append_c(expected, '\n');
+
+		ASSERT_TOKEN_VAL(T_STRING, expected->str);
+		gsdl_tokenizer_get_location(tokenizer, token->offset, &token_line, &token_col);
+		g_assert_cmpint(token_line, ==, line + 1 + i);
+		if (i > 0) g_assert_cmpint(token_col, ==, 4);
+		ASSERT_TOKEN('\n');
+
+		line += 3 + i;
+	}
+	ASSERT_TOKEN(T_EOF);
+
+	gsdl_tokenizer_free(tokenizer);
+	g_string_free(input, TRUE);
+	g_string_free(expected, TRUE);
+}
+
+void test_tokenizer_string_utf8() {
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("\xc3\xa9toile \"\xe2\x80\xb2s\" '\xe2\x80\x93' na\xc3\xafve", &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "\xc3\xa9toile");
+	ASSERT_TOKEN_VAL(T_STRING, "\xe2\x80\xb2s");
+	ASSERT_TOKEN_VAL(T_CHAR, "\xe2\x80\x93");
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "na\xc3\xafve");
+	ASSERT_TOKEN(T_EOF);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+
+	gsdl_tokenizer_free(tokenizer);
+}
+
+void test_tokenizer_string_batch() {
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("tag \"a\\tb\" val=2", &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken tokens[4];
+	gsize n;
+
+	g_assert(gsdl_tokenizer_next_batch(tokenizer, tokens, 4, &n, &error));
+	g_assert_no_error(error);
+	g_assert_cmpint(n, ==, 4);
+	g_assert_cmpint(tokens[0].type, ==, T_IDENTIFIER);
+	g_assert_cmpint(tokens[1].type, ==, T_STRING);
+	g_assert_cmpint(tokens[1].len, ==, 3);
+	g_assert(strncmp(tokens[1].val, "a\tb", 3) == 0);
+	g_assert_cmpint(tokens[2].type, ==, T_IDENTIFIER);
+	g_assert_cmpint(tokens[3].type, ==, '=');
+
+	g_assert(gsdl_tokenizer_next_batch(tokenizer, tokens, 4, &n, &error));
+	g_assert_no_error(error);
+	g_assert_cmpint(n, ==, 2);
+	g_assert_cmpint(tokens[0].type, ==, T_NUMBER);
+	g_assert_cmpint(tokens[1].type, ==, T_EOF);
 
+	g_assert(!gsdl_tokenizer_next_batch(tokenizer, tokens, 4, &n, &error));
 	g_assert_no_error(error);
+	g_assert_cmpint(n, ==, 0);
+
+	gsdl_tokenizer_free(tokenizer);
+
+	tokenizer = gsdl_tokenizer_new_from_string("one two \"three", &error);
+	g_assert(!gsdl_tokenizer_next_batch(tokenizer, tokens, 4, &n, &error));
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_MISSING_DELIMITER);
+	g_assert_cmpint(n, ==, 2);
+
+	gsdl_tokenizer_free(tokenizer);
+}
+
+void test_tokenizer_push() {
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_push();
+
 	g_assert(tokenizer != NULL);
 
 	GSDLToken *token;
-	ASSERT_TOKEN_VAL(T_BINARY, "a32098astas==");
-	ASSERT_TOKEN_VAL(T_BINARY, "astasrarstuotharstfu");
+	g_assert(gsdl_tokenizer_feed(tokenizer, "tag 12", 6, &error));
+	g_assert_no_error(error);
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "tag");
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_no_error(error);
+
+	g_assert(gsdl_tokenizer_feed(tokenizer, "34 \"a\\", 6, &error));
+	g_assert_no_error(error);
+	ASSERT_TOKEN_VAL(T_NUMBER, "1234");
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_no_error(error);
+
+	// Ends in the middle of "é".
+	g_assert(gsdl_tokenizer_feed(tokenizer, "tb\xc3", 3, &error));
+	g_assert_no_error(error);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_no_error(error);
+
+	g_assert(gsdl_tokenizer_feed(tokenizer, "\xa9\" ;", 4, &error));
+	g_assert_no_error(error);
+	ASSERT_TOKEN_VAL(T_STRING, "a\tb\xc3\xa9");
+	ASSERT_TOKEN(';');
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_no_error(error);
+
+	g_assert(gsdl_tokenizer_end(tokenizer, &error));
+	g_assert_no_error(error);
 	ASSERT_TOKEN(T_EOF);
 	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+
+	gsdl_tokenizer_free(tokenizer);
+
+	tokenizer = gsdl_tokenizer_new_push();
+	g_assert(gsdl_tokenizer_feed(tokenizer, "tag \"abc", 8, &error));
+	ASSERT_TOKEN_VAL(T_IDENTIFIER, "tag");
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_no_error(error);
+
+	g_assert(gsdl_tokenizer_end(tokenizer, &error));
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+	g_assert_error(error, GSDL_SYNTAX_ERROR, GSDL_SYNTAX_ERROR_MISSING_DELIMITER);
+
+	gsdl_tokenizer_free(tokenizer);
 }
 
 void test_tokenizer_file_full() {
@@ -189,7 +456,7 @@ void test_tokenizer_file_full() {
 	ASSERT_TOKEN_VAL(T_NUMBER, "03");
 	ASSERT_TOKEN('.');
 	ASSERT_TOKEN_VAL(T_NUMBER, "123");
-	ASSERT_TOKEN_VAL(T_BINARY, "abcs21+");
+	ASSERT_TOKEN_VAL(T_BINARY, "i\xb7,\xdb_");
 	ASSERT_TOKEN_VAL(T_NULL, "null");
 	ASSERT_TOKEN(T_EOF);
 	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
@@ -197,6 +464,24 @@ void test_tokenizer_file_full() {
 	unlink(filename);
 }
 
+void test_tokenizer_file_empty() {
+	char *filename;
+	close(g_file_open_tmp("test-tokenizer.XXXXXX", &filename, NULL));
+
+	GError *error = NULL;
+	GSDLTokenizer *tokenizer = gsdl_tokenizer_new(filename, &error);
+
+	g_assert_no_error(error);
+	g_assert(tokenizer != NULL);
+
+	GSDLToken *token;
+	ASSERT_TOKEN(T_EOF);
+	g_assert(!gsdl_tokenizer_next(tokenizer, &token, &error));
+
+	gsdl_tokenizer_free(tokenizer);
+	unlink(filename);
+}
+
 void test_tokenizer_string_invalid_utf8() {
 	GError *error = NULL;
 	GSDLTokenizer *tokenizer = gsdl_tokenizer_new_from_string("\xff", &error);
@@ -213,13 +498,22 @@ int main(int argc, char **argv) {
 	TEST(string_simple);
 
 	TEST(string_binary);
+	TEST(string_binary_invalid);
 	TEST(string_comments);
 	TEST(string_identifiers);
+	TEST(identifier_chars);
 	TEST(string_keywords);
 	TEST(string_numbers);
+	TEST(string_number_values);
 	TEST(string_strings);
+	TEST(string_slices);
+	TEST(string_long);
+	TEST(string_utf8);
+	TEST(string_batch);
+	TEST(push);
 
 	TEST(file_full);
+	TEST(file_empty);
 
 	TEST(string_invalid_utf8);
 